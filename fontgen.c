@@ -0,0 +1,75 @@
+/** @brief Packs the font.h glyphs into fontpack.h
+ *  @file fontgen.c
+ *  Each bool[8][8] glyph becomes 8 bytes, one per row with bit 7 the
+ *  leftmost column, and a 256 entry table maps every character to its
+ *  glyph. Characters font.h lacks map to FONTUNKNOWN, its glyph for 255.
+ *  Where font.h lists a character twice the first entry wins, as it did
+ *  for the linear search this replaces.
+ *
+ *  Run by the makefile: gcc -o fontgen fontgen.c && ./fontgen > fontpack.h
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "font.h"
+
+int main(void)
+{
+    int nglyphs = sizeof(font) / sizeof(Tfont);
+    int index[256];
+    uint8_t row;
+    int c, i, j, k;
+
+    for(c = 0; c < 256; c++)
+    {
+        index[c] = -1;
+    }
+    for(i = nglyphs - 1; i >= 0; i--)
+    {
+        index[(unsigned char) font[i].caractere] = i;
+    }
+    if(index[255] < 0)
+    {
+        fprintf(stderr,"\nfont.h has no glyph for unknown characters, 255\n");
+        return 1;
+    }
+    for(c = 0; c < 256; c++)
+    {
+        index[c] = (index[c] < 0) ? index[255] : index[c];
+    }
+
+    printf("/** @brief Packed 8x8 font, one byte per row with bit 7 the leftmost column\n");
+    printf(" *  @file fontpack.h\n");
+    printf(" *  Generated by fontgen from font.h, edit font.h and rebuild instead.\n");
+    printf(" */\n");
+    printf("#ifndef FONTPACK_H\n#define FONTPACK_H\n\n");
+    printf("// Includes\n#include <stdint.h>\n\n");
+    printf("// Constants\n#define FONTGLYPHS %d\n#define FONTUNKNOWN %d\n\n", nglyphs, index[255]);
+
+    printf("static const uint8_t fontglyphs[FONTGLYPHS][8] = {\n");
+    for(i = 0; i < nglyphs; i++)
+    {
+        printf("    {");
+        for(j = 0; j < 8; j++)
+        {
+            row = 0;
+            for(k = 0; k < 8; k++)
+            {
+                row |= font[i].binarypattern[j][k] << (7 - k);
+            }
+            printf("0x%02X%s", row, j < 7 ? "," : "");
+        }
+        c = (unsigned char) font[i].caractere;
+        printf("}%s // %d\n", i < nglyphs - 1 ? "," : "", c);
+    }
+    printf("};\n\n");
+
+    printf("static const uint8_t fontindex[256] = {");
+    for(c = 0; c < 256; c++)
+    {
+        printf("%s%d%s", c % 16 == 0 ? "\n    " : "", index[c], c < 255 ? "," : "");
+    }
+    printf("\n};\n\n#endif // FONTPACK_H\n");
+    return 0;
+}
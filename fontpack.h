@@ -0,0 +1,134 @@
+/** @brief Packed 8x8 font, one byte per row with bit 7 the leftmost column
+ *  @file fontpack.h
+ *  Generated by fontgen from font.h, edit font.h and rebuild instead.
+ */
+#ifndef FONTPACK_H
+#define FONTPACK_H
+
+// Includes
+#include <stdint.h>
+
+// Constants
+#define FONTGLYPHS 97
+#define FONTUNKNOWN 26
+
+static const uint8_t fontglyphs[FONTGLYPHS][8] = {
+    {0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00}, // 10
+    {0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00}, // 32
+    {0x60,0x40,0x40,0x40,0x40,0x40,0x40,0x60}, // 91
+    {0x60,0x20,0x20,0x20,0x20,0x20,0x20,0x60}, // 93
+    {0x00,0x10,0x20,0x20,0x40,0x20,0x20,0x10}, // 123
+    {0x00,0x40,0x20,0x20,0x10,0x20,0x20,0x40}, // 125
+    {0x00,0x20,0x40,0x40,0x40,0x40,0x40,0x20}, // 40
+    {0x00,0x40,0x20,0x20,0x20,0x20,0x20,0x40}, // 41
+    {0x00,0x00,0x40,0x20,0x10,0x08,0x04,0x00}, // 92
+    {0x00,0x38,0x44,0x04,0x08,0x10,0x00,0x10}, // 63
+    {0x00,0x08,0x10,0x20,0x40,0x20,0x10,0x08}, // 60
+    {0x00,0x40,0x20,0x10,0x08,0x10,0x20,0x40}, // 62
+    {0x00,0x38,0x44,0x04,0x34,0x54,0x54,0x38}, // 64
+    {0x00,0x28,0x28,0x7C,0x28,0x7C,0x28,0x28}, // 35
+    {0x00,0x00,0x00,0x34,0x58,0x00,0x00,0x00}, // 126
+    {0x00,0x00,0x00,0x00,0x00,0x00,0x60,0x60}, // 46
+    {0x40,0x40,0x00,0x00,0x00,0x00,0x00,0x00}, // 39
+    {0x50,0x50,0x00,0x00,0x00,0x00,0x00,0x00}, // 34
+    {0x00,0x00,0x00,0x00,0x00,0x60,0x20,0x40}, // 44
+    {0x00,0x00,0x60,0x60,0x00,0x60,0x20,0x40}, // 59
+    {0x00,0x00,0x00,0x10,0x00,0x10,0x00,0x00}, // 58
+    {0x00,0x40,0x40,0x40,0x40,0x40,0x00,0x40}, // 33
+    {0x00,0x00,0x00,0x00,0x7C,0x00,0x00,0x00}, // 45
+    {0x00,0x00,0x10,0x10,0x7C,0x10,0x10,0x00}, // 43
+    {0x00,0x00,0x44,0x28,0x10,0x28,0x44,0x00}, // 42
+    {0x00,0x00,0x00,0x00,0x7C,0x00,0x7C,0x00}, // 61
+    {0x00,0x7E,0x42,0x42,0x42,0x42,0x42,0x7E}, // 255
+    {0x04,0x08,0x00,0x38,0x44,0x7C,0x40,0x38}, // 169
+    {0x10,0x08,0x00,0x38,0x44,0x7C,0x40,0x38}, // 168
+    {0x10,0x28,0x00,0x38,0x44,0x7C,0x40,0x38}, // 170
+    {0x10,0x08,0x00,0x38,0x04,0x3C,0x44,0x3C}, // 160
+    {0x10,0x28,0x00,0x38,0x04,0x3C,0x44,0x3C}, // 162
+    {0x00,0x38,0x40,0x40,0x44,0x38,0x10,0x20}, // 167
+    {0x10,0x08,0x00,0x44,0x44,0x44,0x4C,0x34}, // 185
+    {0x00,0x38,0x44,0x4C,0x54,0x64,0x44,0x38}, // 48
+    {0x00,0x20,0x60,0x20,0x20,0x20,0x20,0x70}, // 49
+    {0x00,0x38,0x44,0x04,0x08,0x10,0x20,0x7C}, // 50
+    {0x00,0x7C,0x08,0x10,0x08,0x04,0x44,0x38}, // 51
+    {0x00,0x08,0x18,0x28,0x48,0x7C,0x08,0x08}, // 52
+    {0x00,0x7C,0x40,0x78,0x04,0x04,0x44,0x38}, // 53
+    {0x00,0x18,0x20,0x40,0x78,0x44,0x44,0x38}, // 54
+    {0x00,0x7C,0x04,0x08,0x10,0x10,0x10,0x10}, // 55
+    {0x00,0x38,0x44,0x44,0x38,0x44,0x44,0x38}, // 56
+    {0x00,0x38,0x44,0x44,0x3C,0x04,0x08,0x30}, // 57
+    {0x00,0x60,0x64,0x08,0x10,0x20,0x4C,0x0C}, // 37
+    {0x00,0x00,0x00,0x38,0x04,0x3C,0x44,0x3C}, // 97
+    {0x00,0x38,0x44,0x44,0x7C,0x44,0x44,0x44}, // 65
+    {0x00,0x40,0x40,0x58,0x64,0x44,0x44,0x38}, // 98
+    {0x00,0x78,0x44,0x44,0x78,0x44,0x44,0x78}, // 66
+    {0x00,0x00,0x00,0x38,0x40,0x40,0x44,0x38}, // 99
+    {0x00,0x38,0x44,0x40,0x40,0x40,0x44,0x38}, // 67
+    {0x00,0x04,0x04,0x34,0x4C,0x44,0x44,0x3C}, // 100
+    {0x00,0x70,0x48,0x44,0x44,0x44,0x48,0x70}, // 68
+    {0x00,0x00,0x00,0x38,0x44,0x7C,0x40,0x38}, // 101
+    {0x00,0x7C,0x40,0x40,0x78,0x40,0x40,0x7C}, // 69
+    {0x00,0x10,0x28,0x20,0x70,0x20,0x20,0x20}, // 102
+    {0x00,0x7C,0x40,0x40,0x78,0x40,0x40,0x40}, // 70
+    {0x00,0x00,0x00,0x3C,0x44,0x3C,0x04,0x38}, // 103
+    {0x00,0x38,0x44,0x40,0x5C,0x44,0x44,0x3C}, // 71
+    {0x00,0x40,0x40,0x58,0x64,0x44,0x44,0x44}, // 104
+    {0x00,0x44,0x44,0x44,0x7C,0x44,0x44,0x44}, // 72
+    {0x00,0x20,0x00,0x60,0x20,0x20,0x20,0x70}, // 105
+    {0x00,0x70,0x20,0x20,0x20,0x20,0x20,0x70}, // 73
+    {0x00,0x08,0x00,0x08,0x08,0x08,0x48,0x30}, // 106
+    {0x00,0x1C,0x08,0x08,0x08,0x08,0x48,0x30}, // 74
+    {0x00,0x40,0x40,0x48,0x50,0x60,0x50,0x48}, // 107
+    {0x00,0x44,0x48,0x50,0x60,0x50,0x48,0x44}, // 75
+    {0x00,0x60,0x20,0x20,0x20,0x20,0x20,0x70}, // 108
+    {0x00,0x40,0x40,0x40,0x40,0x40,0x40,0x7C}, // 76
+    {0x00,0x00,0x00,0x68,0x54,0x54,0x54,0x54}, // 109
+    {0x00,0x44,0x6C,0x54,0x54,0x44,0x44,0x44}, // 77
+    {0x00,0x00,0x00,0x58,0x64,0x44,0x44,0x44}, // 110
+    {0x00,0x44,0x44,0x64,0x54,0x4C,0x44,0x44}, // 78
+    {0x00,0x00,0x00,0x38,0x44,0x44,0x44,0x38}, // 111
+    {0x00,0x38,0x44,0x44,0x44,0x44,0x44,0x38}, // 79
+    {0x00,0x00,0x00,0x78,0x44,0x78,0x40,0x40}, // 112
+    {0x00,0x78,0x44,0x44,0x78,0x40,0x40,0x40}, // 80
+    {0x00,0x00,0x00,0x3C,0x44,0x3C,0x04,0x04}, // 113
+    {0x00,0x38,0x44,0x44,0x44,0x54,0x48,0x34}, // 81
+    {0x00,0x00,0x00,0x58,0x60,0x40,0x40,0x40}, // 114
+    {0x00,0x78,0x44,0x44,0x78,0x50,0x48,0x44}, // 82
+    {0x00,0x00,0x00,0x3C,0x40,0x38,0x04,0x78}, // 115
+    {0x00,0x3C,0x40,0x40,0x38,0x04,0x04,0x78}, // 83
+    {0x00,0x00,0x20,0x70,0x20,0x20,0x28,0x10}, // 116
+    {0x00,0x7C,0x10,0x10,0x10,0x10,0x10,0x10}, // 84
+    {0x00,0x00,0x00,0x44,0x44,0x44,0x4C,0x34}, // 117
+    {0x00,0x44,0x44,0x44,0x44,0x44,0x44,0x38}, // 85
+    {0x00,0x00,0x00,0x44,0x44,0x44,0x28,0x10}, // 118
+    {0x00,0x44,0x44,0x44,0x44,0x44,0x28,0x10}, // 86
+    {0x00,0x00,0x00,0x44,0x44,0x54,0x54,0x28}, // 119
+    {0x00,0x44,0x44,0x44,0x54,0x54,0x6C,0x44}, // 87
+    {0x00,0x00,0x00,0x64,0x18,0x10,0x30,0x4C}, // 120
+    {0x00,0x44,0x44,0x28,0x10,0x28,0x44,0x44}, // 88
+    {0x00,0x00,0x00,0x44,0x24,0x18,0x10,0x60}, // 121
+    {0x00,0x44,0x44,0x28,0x10,0x10,0x10,0x10}, // 89
+    {0x00,0x00,0x00,0x7C,0x08,0x10,0x20,0x7C}, // 122
+    {0x00,0x7C,0x04,0x08,0x10,0x20,0x40,0x7C} // 90
+};
+
+static const uint8_t fontindex[256] = {
+    26,26,26,26,26,26,26,26,26,26,0,26,26,26,26,26,
+    26,26,26,26,26,26,26,26,26,26,26,26,26,26,26,26,
+    1,21,17,13,26,44,26,16,6,7,24,23,18,22,15,26,
+    34,35,36,37,38,39,40,41,42,43,20,19,10,25,11,9,
+    12,46,48,50,52,54,56,58,60,62,64,66,68,70,72,74,
+    76,78,80,82,84,86,88,90,92,94,96,2,8,3,26,26,
+    26,45,47,49,51,53,55,57,59,61,63,65,67,69,71,73,
+    75,77,79,81,83,85,87,89,91,93,95,4,26,5,14,26,
+    26,26,26,26,26,26,26,26,26,26,26,26,26,26,26,26,
+    26,26,26,26,26,26,26,26,26,26,26,26,26,26,26,26,
+    30,26,31,26,26,26,26,32,28,27,29,26,26,26,26,26,
+    26,26,26,26,26,26,26,26,26,33,26,26,26,26,26,26,
+    26,26,26,26,26,26,26,26,26,26,26,26,26,26,26,26,
+    26,26,26,26,26,26,26,26,26,26,26,26,26,26,26,26,
+    26,26,26,26,26,26,26,26,26,26,26,26,26,26,26,26,
+    26,26,26,26,26,26,26,26,26,26,26,26,26,26,26,26
+};
+
+#endif // FONTPACK_H
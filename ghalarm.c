@@ -0,0 +1,560 @@
+/** @brief Alarm rules and alarm table
+*   @file ghalarm.c
+*   Alarm conditions are rules in a table: a channel, a comparison, a
+*   threshold, a hysteresis margin, a severity and the alarm code to
+*   report. The first ALARMBASE rules are the configured alarm limits; more
+*   can be added in ALARMRULEFILE, one per line:
+*
+*       # code   channel      cmp  threshold  [hyst H]  [severity S]
+*       HTEMP    temperature  >=   35         hyst 1    severity 2
+*       LPRESS   pressure     <=   970
+*
+*   The channel is temperature, humidity, pressure or an index below
+*   ALARMCHANNELS. Rules are kept as parallel arrays with the comparison
+*   folded into a sign, so all of them are checked ALARMLANES at a time
+*   with vector compares and no branches, giving one bit per rule.
+*
+*   Each rule is a small state machine held as bits. active has a bit for
+*   every raised rule. pending has a bit for every rule that wants to
+*   change state and is waiting out the debounce time, with since[]
+*   holding when it started waiting. A rule is raised when its threshold
+*   is reached, but clears only once the value is back by the hysteresis
+*   margin. Only the bits that differ from the current state are visited,
+*   so the work per cycle follows the number of transitions, not the
+*   number of active alarms. Each transition is recorded as a RAISED or
+*   CLEARED event, which GhAlarmJournal appends to the alarm journal.
+*
+*   When the rules are reloaded GhAlarmTableRules hands the state of each
+*   rule to the new rule with the same code, channel and comparison,
+*   wherever it now sits, and clears only the alarms of rules that are gone.
+*/
+
+#include "ghalarm.h"
+#include "ghwatch.h"
+#include <fcntl.h>
+#include <unistd.h>
+
+typedef float alarmvecf_t __attribute__((vector_size(ALARMLANES * sizeof(float))));
+typedef int32_t alarmveci_t __attribute__((vector_size(ALARMLANES * sizeof(int32_t))));
+
+static const char alarmcodes[NALARMS][8] = {"NOALARM","HTEMP","LTEMP","HHUMID","LHUMID","HPRESS","LPRESS"};
+static const char alarmchannels[SENSORS][12] = {"temperature","humidity","pressure"};
+
+/**
+ * @brief Sets one rule of a table
+ * @param rs rule table
+ * @param r rule index
+ * @param code alarm code to report
+ * @param channel channel index
+ * @param high 1 to trip at or above limit, 0 at or below
+ * @param limit threshold
+ * @param hyst hysteresis margin
+ * @param severity severity to report
+ * @return void
+ */
+static void GhAlarmRuleSet(alarmrules_s * rs, int r, alarm_e code, int channel, int high, float limit, float hyst, int severity)
+{
+    rs->code[r] = code;
+    rs->channel[r] = channel;
+    rs->sign[r] = high ? 1.0f : -1.0f;
+    rs->limit[r] = limit;
+    rs->hyst[r] = hyst;
+    rs->severity[r] = severity;
+}
+
+/**
+ * @brief Makes the first ALARMBASE rules the configured alarm limits
+ * @version CENG153, serial: 85048a62
+ * @author Devansh Patel
+ * @since 2026-10-19
+ * @param rs rule table, rules after the first ALARMBASE are kept
+ * @param alarmpt Alarm limits and hysteresis margins
+ * @return void
+ */
+void GhAlarmRulesDefault(alarmrules_s * rs, alarmlimit_s alarmpt)
+{
+    GhAlarmRuleSet(rs, 0, HTEMP, TEMPERATURE, 1, alarmpt.hight, alarmpt.hystt, 1);
+    GhAlarmRuleSet(rs, 1, LTEMP, TEMPERATURE, 0, alarmpt.lowt, alarmpt.hystt, 1);
+    GhAlarmRuleSet(rs, 2, HHUMID, HUMIDITY, 1, alarmpt.highh, alarmpt.hysth, 1);
+    GhAlarmRuleSet(rs, 3, LHUMID, HUMIDITY, 0, alarmpt.lowh, alarmpt.hysth, 1);
+    GhAlarmRuleSet(rs, 4, HPRESS, PRESSURE, 1, alarmpt.highp, alarmpt.hystp, 1);
+    GhAlarmRuleSet(rs, 5, LPRESS, PRESSURE, 0, alarmpt.lowp, alarmpt.hystp, 1);
+    rs->limits = alarmpt;
+    if(rs->n < ALARMBASE)
+    {
+        rs->n = ALARMBASE;
+    }
+}
+
+/**
+ * @brief Looks up a name in a table of fixed-size names
+ * @param name name to find
+ * @param names table
+ * @param count entries in the table
+ * @param size size of each entry
+ * @return int index, -1 if not found
+ */
+static int GhAlarmLookup(const char * name, const char * names, int count, size_t size)
+{
+    int i;
+
+    for(i = 0; i < count; i++)
+    {
+        if(strcmp(name, names + i * size) == 0)
+        {
+            return i;
+        }
+    }
+    return -1;
+}
+
+/**
+ * @brief Appends the rules of a rule file to a table
+ * @version CENG153, serial: 85048a62
+ * @author Devansh Patel
+ * @since 2026-10-19
+ * @param fname rule file name
+ * @param rs rule table, its first ALARMBASE rules already set
+ * @return int 1 if the file does not exist or all its rules were added, 0 if it has errors
+ */
+int GhAlarmRulesLoad(const char * fname, alarmrules_s * rs)
+{
+    char line[ALARMLINESZ], code[ALARMTOKSZ], chan[ALARMTOKSZ], cmp[ALARMTOKSZ], key[ALARMTOKSZ];
+    int lineno = 0, ok = 1, c, ch, sev, used, off, bad;
+    float limit, hyst, v;
+    char * end;
+    FILE *fp;
+
+    fp = fopen(fname,"r");
+    if(fp == NULL)
+    {
+        return 1;
+    }
+    while(fgets(line, sizeof(line), fp) != NULL)
+    {
+        lineno++;
+        line[strcspn(line, "#\n")] = '\0';
+        if(sscanf(line, " %15s", code) != 1)
+        {
+            continue;
+        }
+        hyst = 0;
+        sev = 1;
+        bad = sscanf(line, " %15s %15s %15s %f%n", code, chan, cmp, &limit, &off) != 4;
+        // Optional settings follow as key value pairs
+        while(!bad && sscanf(line + off, " %15s %f%n", key, &v, &used) == 2)
+        {
+            off += used;
+            if(strcmp(key, "hyst") == 0 && v >= 0)
+            {
+                hyst = v;
+            }
+            else if(strcmp(key, "severity") == 0 && v == (int) v)
+            {
+                sev = v;
+            }
+            else
+            {
+                bad = 1;
+            }
+        }
+        c = GhAlarmLookup(code, alarmcodes[0], NALARMS, sizeof(alarmcodes[0]));
+        ch = GhAlarmLookup(chan, alarmchannels[0], SENSORS, sizeof(alarmchannels[0]));
+        if(ch < 0)
+        {
+            ch = strtol(chan, &end, 10);
+            ch = (*end == '\0' && end != chan && ch >= 0 && ch < ALARMCHANNELS) ? ch : -1;
+        }
+        if(bad || line[off + strspn(line + off, " \t\r")] != '\0' || c <= NOALARM || ch < 0 ||
+           (strcmp(cmp, ">=") != 0 && strcmp(cmp, "<=") != 0) || !(limit == limit))
+        {
+            fprintf(stderr,"\n%s line %d: expected code channel >=|<= threshold [hyst H] [severity S]\n", fname, lineno);
+            ok = 0;
+            continue;
+        }
+        if(rs->n == ALARMRULES)
+        {
+            fprintf(stderr,"\n%s line %d: more than %d rules\n", fname, lineno, ALARMRULES);
+            ok = 0;
+            break;
+        }
+        GhAlarmRuleSet(rs, rs->n++, c, ch, cmp[0] == '>', limit, hyst, sev);
+    }
+    fclose(fp);
+    return ok;
+}
+
+/**
+ * @brief Keeps a rule table in step with the alarm limits and the rule file
+ * @version CENG153, serial: 85048a62
+ * @author Devansh Patel
+ * @since 2026-10-19
+ * @param rs rule table, zeroed before first use
+ * @param alarmpt current Alarm limits
+ * @return int 1 if the rules changed
+ */
+int GhAlarmRulesUpdate(alarmrules_s * rs, alarmlimit_s alarmpt)
+{
+    static int rulewatch = -2;
+    static alarmrules_s fresh;
+
+    if(rulewatch == -2)
+    {
+        rulewatch = GhWatchAdd(ALARMRULEFILE);
+    }
+    if(GhWatchChanged(rulewatch))
+    {
+        // A rule file with errors leaves the rules in use as they are
+        fresh.n = 0;
+        GhAlarmRulesDefault(&fresh, alarmpt);
+        if(GhAlarmRulesLoad(ALARMRULEFILE, &fresh))
+        {
+            *rs = fresh;
+            return 1;
+        }
+    }
+    if(rs->n < ALARMBASE || memcmp(&rs->limits, &alarmpt, sizeof(alarmlimit_s)) != 0)
+    {
+        GhAlarmRulesDefault(rs, alarmpt);
+        return 1;
+    }
+    return 0;
+}
+
+/**
+ * @brief Spreads a reading over the channel array the rules index
+ * @version CENG153, serial: 85048a62
+ * @author Devansh Patel
+ * @since 2026-10-19
+ * @param rdata Reading data
+ * @param ch channel values, ALARMCHANNELS entries
+ * @return void
+ */
+void GhAlarmChannels(reading_s rdata, float * ch)
+{
+    int i;
+
+    ch[TEMPERATURE] = rdata.temperature;
+    ch[HUMIDITY] = rdata.humidity;
+    ch[PRESSURE] = rdata.pressure;
+    for(i = SENSORS; i < ALARMCHANNELS; i++)
+    {
+        ch[i] = 0;
+    }
+}
+
+/**
+ * @brief Checks every rule against the channels
+ * @version CENG153, serial: 85048a62
+ * @author Devansh Patel
+ * @since 2026-10-19
+ * @param rs rule table
+ * @param ch channel values, ALARMCHANNELS entries
+ * @param trip bit per rule whose threshold is reached, ALARMWORDS words
+ * @param clear bit per rule that is back past its hysteresis margin, ALARMWORDS words
+ * @return void
+ */
+void GhAlarmRulesEval(const alarmrules_s * rs, const float * ch, uint32_t * trip, uint32_t * clear)
+{
+    alarmvecf_t x, s, l, h, d;
+    alarmveci_t t, c;
+    uint32_t tb, cb;
+    int i, k;
+
+    memset(trip, 0, ALARMWORDS * sizeof(uint32_t));
+    memset(clear, 0, ALARMWORDS * sizeof(uint32_t));
+    for(i = 0; i < rs->n; i += ALARMLANES)
+    {
+        for(k = 0; k < ALARMLANES; k++)
+        {
+            x[k] = ch[rs->channel[i + k] & (ALARMCHANNELS - 1)];
+        }
+        memcpy(&s, &rs->sign[i], sizeof(s));
+        memcpy(&l, &rs->limit[i], sizeof(l));
+        memcpy(&h, &rs->hyst[i], sizeof(h));
+        // With the sign folded in, every rule trips at d >= 0 whatever its comparison
+        d = s * (x - l);
+        t = d >= 0;
+        c = d < -h;
+        tb = 0;
+        cb = 0;
+        for(k = 0; k < ALARMLANES; k++)
+        {
+            tb |= (uint32_t) (t[k] & 1) << k;
+            cb |= (uint32_t) (c[k] & 1) << k;
+        }
+        trip[i / 32] |= tb << (i % 32);
+        clear[i / 32] |= cb << (i % 32);
+    }
+    // Lanes past the last rule hold stale entries
+    if(rs->n % 32)
+    {
+        trip[rs->n / 32] &= (1u << (rs->n % 32)) - 1;
+        clear[rs->n / 32] &= (1u << (rs->n % 32)) - 1;
+    }
+}
+
+/**
+ * @brief Advances every rule's state machine by one set of channel values
+ * @version CENG153, serial: 85048a62
+ * @author Devansh Patel
+ * @since 2026-10-19
+ * @param at alarm table, zeroed before first use
+ * @param rs rule table
+ * @param ch channel values, ALARMCHANNELS entries
+ * @param now time of the values
+ * @param debounce seconds a change must hold before it takes effect
+ * @return int number of RAISED and CLEARED events, left in at->events
+ */
+int GhAlarmTableUpdate(alarmtable_s * at, const alarmrules_s * rs, const float * ch, time_t now, float debounce)
+{
+    uint32_t trip[ALARMWORDS], clear[ALARMWORDS];
+    uint32_t want, diff, bits, bit;
+    alarmevent_s * ev;
+    int w, r, code;
+
+    GhAlarmRulesEval(rs, ch, trip, clear);
+    at->nevents = 0;
+    for(w = 0; w < ALARMWORDS; w++)
+    {
+        // An active alarm stays up inside the hysteresis band
+        want = trip[w] | (at->active[w] & ~clear[w]);
+        diff = want ^ at->active[w];
+        // A rule that went back before its debounce time ran out starts over next time
+        at->pending[w] &= diff;
+        for(bits = diff; bits != 0; bits &= bits - 1)
+        {
+            r = w * 32 + __builtin_ctz(bits);
+            bit = bits & -bits;
+            if(!(at->pending[w] & bit))
+            {
+                at->pending[w] |= bit;
+                at->since[r] = now;
+            }
+            if(now - at->since[r] < debounce)
+            {
+                continue;
+            }
+
+            at->pending[w] &= ~bit;
+            at->active[w] ^= bit;
+            ev = &at->events[at->nevents++];
+            ev->raised = (at->active[w] & bit) != 0;
+            // A clear undoes what the raise counted
+            code = ev->raised ? rs->code[r] : at->slot[r].code;
+            ev->code = code;
+            ev->rule = r;
+            ev->severity = rs->severity[r];
+            ev->etime = now;
+            ev->value = ch[rs->channel[r]];
+            at->codecount[code] += ev->raised ? 1 : -1;
+            at->codes = (at->codes & ~(1u << code)) | (uint32_t) (at->codecount[code] > 0) << code;
+            if(ev->raised)
+            {
+                at->slot[r].code = code;
+                at->slot[r].atime = at->since[r];
+                at->slot[r].value = ev->value;
+            }
+        }
+    }
+    return at->nevents;
+}
+
+/**
+ * @brief Finds the rule of a new table that continues a rule of the old one
+ * @param old rule table the alarm table was built against
+ * @param r rule index in old
+ * @param rs new rule table
+ * @param taken bit per rule of rs already matched, ALARMWORDS words
+ * @return int rule index in rs with the same code, channel and comparison, -1 if there is none
+ */
+static int GhAlarmRuleMatch(const alarmrules_s * old, int r, const alarmrules_s * rs, const uint32_t * taken)
+{
+    int k, i;
+
+    // Most reloads leave the rule where it was, so that index is tried first
+    for(k = -1; k < rs->n; k++)
+    {
+        i = (k < 0) ? r : k;
+        if(i < rs->n && !(taken[i / 32] & (1u << (i % 32))) && rs->code[i] == old->code[r] &&
+           rs->channel[i] == old->channel[r] && rs->sign[i] == old->sign[r])
+        {
+            return i;
+        }
+    }
+    return -1;
+}
+
+/**
+ * @brief Brings an alarm table in line with a rule table that just changed
+ * @version CENG153, serial: 85048a62
+ * @author Devansh Patel
+ * @since 2026-10-19
+ * @param at alarm table
+ * @param rs rule table after GhAlarmRulesUpdate returned 1
+ * @param now time of the change
+ * @return int number of CLEARED events, left in at->events
+ */
+int GhAlarmTableRules(alarmtable_s * at, const alarmrules_s * rs, time_t now)
+{
+    const alarmrules_s * old = &at->rules;
+    uint32_t active[ALARMWORDS] = {0}, pending[ALARMWORDS] = {0}, taken[ALARMWORDS] = {0};
+    time_t since[ALARMRULES];
+    alarm_s slot[ALARMRULES];
+    alarmevent_s * ev;
+    uint32_t bits, bit;
+    int w, r, i;
+
+    at->nevents = 0;
+    memset(slot, 0, sizeof(slot));
+    // Rules are matched by what they watch, not by index, so editing a threshold or a line above keeps the state
+    for(w = 0; w < ALARMWORDS; w++)
+    {
+        for(bits = at->active[w] | at->pending[w]; bits != 0; bits &= bits - 1)
+        {
+            r = w * 32 + __builtin_ctz(bits);
+            bit = bits & -bits;
+            i = GhAlarmRuleMatch(old, r, rs, taken);
+            if(i >= 0)
+            {
+                // The next GhAlarmTableUpdate checks it against the new threshold and hysteresis
+                taken[i / 32] |= 1u << (i % 32);
+                active[i / 32] |= (at->active[w] & bit) ? 1u << (i % 32) : 0;
+                pending[i / 32] |= (at->pending[w] & bit) ? 1u << (i % 32) : 0;
+                since[i] = at->since[r];
+                slot[i] = at->slot[r];
+            }
+            else if(at->active[w] & bit)
+            {
+                ev = &at->events[at->nevents++];
+                ev->code = at->slot[r].code;
+                ev->rule = r;
+                ev->severity = old->severity[r];
+                ev->raised = 0;
+                ev->etime = now;
+                ev->value = at->slot[r].value;
+            }
+        }
+    }
+    memcpy(at->active, active, sizeof(active));
+    memcpy(at->pending, pending, sizeof(pending));
+    memcpy(at->since, since, sizeof(since));
+    memcpy(at->slot, slot, sizeof(slot));
+
+    memset(at->codecount, 0, sizeof(at->codecount));
+    at->codes = 0;
+    for(w = 0; w < ALARMWORDS; w++)
+    {
+        for(bits = at->active[w]; bits != 0; bits &= bits - 1)
+        {
+            r = w * 32 + __builtin_ctz(bits);
+            at->codecount[at->slot[r].code]++;
+            at->codes |= 1u << at->slot[r].code;
+        }
+    }
+    at->rules = *rs;
+    return at->nevents;
+}
+
+/**
+ * @brief Links the active alarms of a table into the alarm list other functions expect
+ * @version CENG153, serial: 85048a62
+ * @author Devansh Patel
+ * @since 2026-10-19
+ * @param at alarm table
+ * @return alarm_s* head of the list in rule order, a single NOALARM entry if none are active
+ */
+alarm_s * GhAlarmList(alarmtable_s * at)
+{
+    alarm_s * head = NULL;
+    alarm_s ** link = &head;
+    uint32_t bits;
+    int w, r;
+
+    for(w = 0; w < ALARMWORDS; w++)
+    {
+        for(bits = at->active[w]; bits != 0; bits &= bits - 1)
+        {
+            r = w * 32 + __builtin_ctz(bits);
+            *link = &at->slot[r];
+            link = &at->slot[r].next;
+        }
+    }
+    *link = NULL;
+    if(head == NULL)
+    {
+        at->none.code = NOALARM;
+        at->none.next = NULL;
+        head = &at->none;
+    }
+    return head;
+}
+
+/**
+ * @brief Opens the alarm journal for appending
+ * @version CENG153, serial: 85048a62
+ * @author Devansh Patel
+ * @since 2026-10-19
+ * @param fname journal file name
+ * @return int file descriptor, -1 if the journal cannot be opened
+ */
+int GhAlarmJournalOpen(const char * fname)
+{
+    int fd;
+
+    fd = open(fname, O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+    if(fd < 0)
+    {
+        fprintf(stderr,"\nCan't open alarm journal %s\n", fname);
+    }
+    return fd;
+}
+
+/**
+ * @brief Formats one alarm event as a journal line, time,RAISED|CLEARED,name,value,severity
+ * @version CENG153, serial: 85048a62
+ * @author Devansh Patel
+ * @since 2026-10-19
+ * @param buf destination, ALARMLINESZ bytes is always enough
+ * @param size size of buf
+ * @param ev event to format
+ * @return int length of the line written, newline included
+ */
+int GhAlarmFormat(char * buf, size_t size, const alarmevent_s * ev)
+{
+    char stamp[CTIMESTRSZ];
+    struct tm lt;
+    int n;
+
+    localtime_r(&ev->etime, &lt);
+    strftime(stamp, sizeof(stamp), "%Y-%m-%d %H:%M:%S", &lt);
+    n = snprintf(buf, size, "%s,%s,%s,%.1f,%d\n", stamp, ev->raised ? "RAISED" : "CLEARED",
+                 alarmnames[ev->code], ev->value, ev->severity);
+    return (n < (int) size) ? n : (int) size - 1;
+}
+
+/**
+ * @brief Appends the events of the last update to the alarm journal, one line each
+ * @version CENG153, serial: 85048a62
+ * @author Devansh Patel
+ * @since 2026-10-19
+ * @param fd journal from GhAlarmJournalOpen, -1 to do nothing
+ * @param at alarm table after GhAlarmTableUpdate
+ * @return int 1 on success, 0 on a write error
+ */
+int GhAlarmJournal(int fd, const alarmtable_s * at)
+{
+    char line[ALARMLINESZ * ALARMRULES];
+    int i, len = 0;
+
+    if(fd < 0 || at->nevents == 0)
+    {
+        return 1;
+    }
+    for(i = 0; i < at->nevents; i++)
+    {
+        len += GhAlarmFormat(line + len, ALARMLINESZ, &at->events[i]);
+    }
+    // One write, so a cycle's events are never interleaved with another writer's
+    return write(fd, line, len) == len;
+}
@@ -0,0 +1,75 @@
+/** @brief Alarm rule and alarm table constants, structures, function prototypes
+*   @file ghalarm.h
+*/
+
+#ifndef GHALARM_H
+#define GHALARM_H
+
+// Includes
+#include <stdint.h>
+#include "ghcontrol.h"
+
+// Constants
+#define ALARMJOURNAL "ghalarms.log"
+#define ALARMLINESZ 96
+#define ALARMRULEFILE "ghrules.conf"
+#define ALARMRULES 256
+#define ALARMWORDS (ALARMRULES / 32)
+#define ALARMBASE 6
+#define ALARMCHANNELS 8
+#define ALARMLANES 4
+#define ALARMTOKSZ 16
+
+// Structures
+typedef struct alarmrules
+{
+    int n;
+    alarmlimit_s limits;
+    float sign[ALARMRULES] __attribute__((aligned(16)));
+    float limit[ALARMRULES] __attribute__((aligned(16)));
+    float hyst[ALARMRULES] __attribute__((aligned(16)));
+    int channel[ALARMRULES];
+    int severity[ALARMRULES];
+    alarm_e code[ALARMRULES];
+} alarmrules_s;
+
+typedef struct alarmevent
+{
+    alarm_e code;
+    int rule;
+    int severity;
+    int raised;
+    time_t etime;
+    float value;
+} alarmevent_s;
+
+typedef struct alarmtable
+{
+    uint32_t active[ALARMWORDS];
+    uint32_t pending[ALARMWORDS];
+    uint32_t codes;
+    int codecount[NALARMS];
+    time_t since[ALARMRULES];
+    alarm_s slot[ALARMRULES];
+    alarm_s none;
+    alarmrules_s rules;
+    int nevents;
+    alarmevent_s events[ALARMRULES];
+} alarmtable_s;
+
+extern const char alarmnames[NALARMS][ALARMNMSZ];
+
+//@cond INTERNAL
+void GhAlarmRulesDefault(alarmrules_s * rs, alarmlimit_s alarmpt);
+int GhAlarmRulesLoad(const char * fname, alarmrules_s * rs);
+int GhAlarmRulesUpdate(alarmrules_s * rs, alarmlimit_s alarmpt);
+void GhAlarmRulesEval(const alarmrules_s * rs, const float * ch, uint32_t * trip, uint32_t * clear);
+void GhAlarmChannels(reading_s rdata, float * ch);
+int GhAlarmTableUpdate(alarmtable_s * at, const alarmrules_s * rs, const float * ch, time_t now, float debounce);
+int GhAlarmTableRules(alarmtable_s * at, const alarmrules_s * rs, time_t now);
+alarm_s * GhAlarmList(alarmtable_s * at);
+int GhAlarmFormat(char * buf, size_t size, const alarmevent_s * ev);
+int GhAlarmJournalOpen(const char * fname);
+int GhAlarmJournal(int fd, const alarmtable_s * at);
+//@endcond
+#endif
@@ -0,0 +1,298 @@
+/** @brief Timed LED animations advanced between control cycles
+*   @file ghanim.c
+*   The main loop draws a scene with GhDisplayAll and then, instead of
+*   sleeping until the next cycle, hands the remaining time to GhAnimRun.
+*   That paces frames at ANIMFPS against absolute CLOCK_MONOTONIC
+*   deadlines and steps the animation state machine once per frame:
+*
+*       ANIMSHOW    the scene as drawn
+*       ANIMWIPE    the new scene slides in over the old, a column a frame
+*       ANIMSCROLL  text pushes the scene off the left edge, then wipes back
+*
+*   A blinking alarm indicator is laid over ANIMSHOW and ANIMWIPE frames.
+*   Frames go through the compositor, so frames that don't change are
+*   never written to the device. A frame woken more than ANIMLATENS after
+*   its deadline counts as late. If whole frame periods were missed they
+*   are skipped rather than run back to back.
+*/
+
+#include "ghanim.h"
+#include <errno.h>
+
+/**
+ * @brief Moves a time forward
+ * @param ts time
+ * @param ns nanoseconds to add
+ * @return void
+ */
+static void GhAnimAdd(struct timespec * ts, long ns)
+{
+    ts->tv_sec += ns / 1000000000L;
+    ts->tv_nsec += ns % 1000000000L;
+    if(ts->tv_nsec >= 1000000000L)
+    {
+        ts->tv_sec++;
+        ts->tv_nsec -= 1000000000L;
+    }
+}
+
+/**
+ * @brief Difference of two times
+ * @param a later time
+ * @param b earlier time
+ * @return double a - b in nanoseconds
+ */
+static double GhAnimDiff(const struct timespec * a, const struct timespec * b)
+{
+    return (a->tv_sec - b->tv_sec) * 1e9 + (a->tv_nsec - b->tv_nsec);
+}
+
+/**
+ * @brief Sleeps until an absolute monotonic time
+ * @param ts wake-up time
+ * @return void
+ */
+static void GhAnimSleep(const struct timespec * ts)
+{
+    while(clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, ts, NULL) == EINTR);
+}
+
+/**
+ * @brief Starts a wipe from the frame last shown to the scene
+ * @param an animation
+ * @return void
+ */
+static void GhAnimWipe(anim_s * an)
+{
+    an->from = an->base;
+    an->state = ANIMWIPE;
+    an->step = 0;
+}
+
+/**
+ * @brief Prepares the animation engine in front of a compositor
+ * @version CENG153, serial: 85048a62
+ * @author Devansh Patel
+ * @since 2026-10-19
+ * @param an animation to initialise
+ * @param panel compositor the frames are presented through
+ * @return void
+ */
+void GhAnimInit(anim_s * an, struct compositor_t * panel)
+{
+    memset(an, 0, sizeof(*an));
+    an->panel = panel;
+    an->state = ANIMSHOW;
+    clock_gettime(CLOCK_MONOTONIC, &an->next);
+    GhAnimAdd(&an->next, ANIMFRAMENS);
+}
+
+/**
+ * @brief Takes a freshly drawn scene, wiping it in if it differs from the one shown
+ * @version CENG153, serial: 85048a62
+ * @author Devansh Patel
+ * @since 2026-10-19
+ * @param an animation whose scene buffer was just drawn
+ * @return void
+ */
+void GhAnimScene(anim_s * an)
+{
+    // A scroll wipes back to whatever the scene is when it ends, a running wipe just retargets
+    if(an->state == ANIMSHOW && memcmp(&an->scene, &an->base, sizeof(struct fb_t)) != 0)
+    {
+        GhAnimWipe(an);
+    }
+}
+
+/**
+ * @brief Scrolls a line of text across the panel, replacing any scroll in progress
+ * @version CENG153, serial: 85048a62
+ * @author Devansh Patel
+ * @since 2026-10-19
+ * @param an animation
+ * @param text text to scroll, copied
+ * @param color text colour
+ * @return void
+ */
+void GhAnimScroll(anim_s * an, const char * text, uint16_t color)
+{
+    strncpy(an->text, text, ANIMTEXTSZ - 1);
+    an->text[ANIMTEXTSZ - 1] = '\0';
+    an->textcolor = color;
+    an->textfb = an->base;
+    ShScrollStart(&an->scroll, an->text);
+    an->state = ANIMSCROLL;
+    an->step = 0;
+}
+
+/**
+ * @brief Turns the blinking alarm indicator on or off
+ * @version CENG153, serial: 85048a62
+ * @author Devansh Patel
+ * @since 2026-10-19
+ * @param an animation
+ * @param on non-zero while any alarm is active
+ * @return void
+ */
+void GhAnimBlink(anim_s * an, int on)
+{
+    an->blink = on;
+}
+
+/**
+ * @brief Blinks while alarms are active and scrolls the name of an alarm just raised
+ * @version CENG153, serial: 85048a62
+ * @author Devansh Patel
+ * @since 2026-10-19
+ * @param an animation
+ * @param at alarm table after GhAlarmTableUpdate
+ * @return void
+ */
+void GhAnimAlarms(anim_s * an, const alarmtable_s * at)
+{
+    char text[ANIMTEXTSZ];
+    int i;
+
+    GhAnimBlink(an, at->codes != 0);
+    for(i = at->nevents - 1; i >= 0; i--)
+    {
+        if(at->events[i].raised)
+        {
+            snprintf(text, sizeof(text), "%s %.1f", alarmnames[at->events[i].code], at->events[i].value);
+            GhAnimScroll(an, text, RED);
+            break;
+        }
+    }
+}
+
+/**
+ * @brief Advances the animation one frame and presents it
+ * @version CENG153, serial: 85048a62
+ * @author Devansh Patel
+ * @since 2026-10-19
+ * @param an animation
+ * @return void
+ */
+void GhAnimFrame(anim_s * an)
+{
+    struct fb_t * back = &an->panel->back;
+    int row, col;
+
+    an->tick++;
+    switch(an->state)
+    {
+    case ANIMSCROLL:
+        if(an->step++ % ANIMSCROLLFRAMES == 0 && !ShScrollStep(&an->scroll, an->textcolor, BLACK, &an->textfb))
+        {
+            GhAnimWipe(an);
+        }
+        an->base = an->textfb;
+        break;
+    case ANIMWIPE:
+        // Columns left of the edge come from the new scene
+        an->step++;
+        for(row = 0; row < 8; row++)
+        {
+            for(col = 0; col < 8; col++)
+            {
+                an->base.pixel[row][col] = (col < an->step) ? an->scene.pixel[row][col] : an->from.pixel[row][col];
+            }
+        }
+        if(an->step >= 8)
+        {
+            an->state = ANIMSHOW;
+        }
+        break;
+    default:
+        an->base = an->scene;
+        break;
+    }
+
+    *back = an->base;
+    if(an->blink && an->state != ANIMSCROLL && (an->tick / ANIMBLINKFRAMES) % 2 == 0)
+    {
+        for(row = 0; row < 8; row++)
+        {
+            back->pixel[row][ANIMBLINKCOL] = RED;
+        }
+    }
+    ShPresent(an->panel);
+}
+
+/**
+ * @brief Moves a control cycle deadline on by one period, never into the past
+ * @version CENG153, serial: 85048a62
+ * @author Devansh Patel
+ * @since 2026-10-19
+ * @param cycle deadline of the cycle just run
+ * @param ms cycle period in milliseconds
+ * @return void
+ */
+void GhAnimNextCycle(struct timespec * cycle, int ms)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    GhAnimAdd(cycle, ms * 1000000L);
+    // A cycle that overran starts the cadence again rather than running the missed ones back to back
+    if(GhAnimDiff(cycle, &now) < 0)
+    {
+        *cycle = now;
+    }
+}
+
+/**
+ * @brief Runs animation frames at ANIMFPS until a control cycle deadline
+ * @version CENG153, serial: 85048a62
+ * @author Devansh Patel
+ * @since 2026-10-19
+ * @param an animation
+ * @param until deadline of the next control cycle
+ * @return int number of frames run
+ */
+int GhAnimRun(anim_s * an, const struct timespec * until)
+{
+    struct timespec now;
+    double late;
+    long missed;
+    int frames = 0;
+
+    while(GhAnimDiff(until, &an->next) >= 0)
+    {
+        GhAnimSleep(&an->next);
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        late = GhAnimDiff(&now, &an->next);
+        an->stats.frames++;
+        an->stats.sumlate += late;
+        an->stats.late += late > ANIMLATENS;
+        if(late > an->stats.maxlate)
+        {
+            an->stats.maxlate = late;
+        }
+        // Stay on the frame grid, dropping the periods that were missed
+        missed = late / ANIMFRAMENS;
+        an->stats.skipped += missed;
+        GhAnimAdd(&an->next, (missed + 1) * ANIMFRAMENS);
+        GhAnimFrame(an);
+        frames++;
+    }
+    GhAnimSleep(until);
+    return frames;
+}
+
+/**
+ * @brief Prints the frame pacing statistics
+ * @version CENG153, serial: 85048a62
+ * @author Devansh Patel
+ * @since 2026-10-19
+ * @param an animation
+ * @return void
+ */
+void GhAnimDisplayStats(const anim_s * an)
+{
+    const animstats_s * st = &an->stats;
+
+    printf("\nDisplay %lu frames at %d fps, %lu late, %lu skipped, %lu written, lateness mean %.2f ms max %.2f ms\n",
+           st->frames, ANIMFPS, st->late, st->skipped, an->panel->presented,
+           st->frames ? st->sumlate / st->frames / 1e6 : 0.0, st->maxlate / 1e6);
+}
@@ -0,0 +1,64 @@
+/** @brief LED animation engine constants, structures, function prototypes
+*   @file ghanim.h
+*/
+
+#ifndef GHANIM_H
+#define GHANIM_H
+
+// Includes
+#include <time.h>
+#include "ghcontrol.h"
+#include "ghalarm.h"
+
+// Constants
+#define ANIMFPS 25
+#define ANIMFRAMENS (1000000000L / ANIMFPS)
+#define ANIMLATENS 2000000L
+#define ANIMSCROLLFRAMES 2
+#define ANIMBLINKFRAMES (ANIMFPS / 2)
+#define ANIMBLINKCOL 0
+#define ANIMTEXTSZ 64
+
+// Enumerated Types
+typedef enum { ANIMSHOW, ANIMWIPE, ANIMSCROLL } animstate_e;
+
+// Structures
+typedef struct animstats
+{
+    unsigned long frames;
+    unsigned long late;
+    unsigned long skipped;
+    double sumlate;
+    double maxlate;
+} animstats_s;
+
+typedef struct anim
+{
+    struct compositor_t * panel;
+    struct fb_t scene;
+    struct fb_t base;
+    struct fb_t from;
+    struct fb_t textfb;
+    struct scroller_t scroll;
+    char text[ANIMTEXTSZ];
+    uint16_t textcolor;
+    animstate_e state;
+    int step;
+    int blink;
+    unsigned long tick;
+    struct timespec next;
+    animstats_s stats;
+} anim_s;
+
+//@cond INTERNAL
+void GhAnimInit(anim_s * an, struct compositor_t * panel);
+void GhAnimScene(anim_s * an);
+void GhAnimScroll(anim_s * an, const char * text, uint16_t color);
+void GhAnimBlink(anim_s * an, int on);
+void GhAnimAlarms(anim_s * an, const alarmtable_s * at);
+void GhAnimFrame(anim_s * an);
+void GhAnimNextCycle(struct timespec * cycle, int ms);
+int GhAnimRun(anim_s * an, const struct timespec * until);
+void GhAnimDisplayStats(const anim_s * an);
+//@endcond
+#endif
@@ -0,0 +1,478 @@
+/** @brief Delta-of-delta / XOR compressed time-series blocks
+*   @file ghblock.c
+*   Each block holds up to BLOCKSAMPLES readings and decodes on its own.
+*   Timestamps are stored as delta-of-delta, so a steady GHUPDATE cadence
+*   costs one bit per sample. Readings are rounded to the 0.1 precision
+*   of ghdata.txt and stored as the XOR against the previous value, so an
+*   unchanged reading costs one bit as well.
+*
+*   Block layout: "GHZB", u16 count, u16 version, u32 payload bytes,
+*   i64 first time, i64 last time, then the bit stream, all little-endian.
+*/
+
+#include "ghblock.h"
+#include "ghlog.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <math.h>
+#include <unistd.h>
+
+/**
+ * @brief Appends the low n bits of v to the block, most significant first
+ * @param enc encoder
+ * @param v bits
+ * @param n number of bits, at most 32
+ * @return void
+ */
+static void GhBitPut(blockenc_s * enc, uint32_t v, int n)
+{
+    enc->acc = (enc->acc << n) | (v & (uint32_t) ((1ULL << n) - 1));
+    enc->nacc += n;
+    while(enc->nacc >= 8)
+    {
+        enc->nacc -= 8;
+        enc->buf[enc->len++] = (uint8_t) (enc->acc >> enc->nacc);
+    }
+}
+
+/**
+ * @brief Float bits of a reading rounded to the precision of the text log
+ * @param x reading
+ * @return uint32_t IEEE-754 bits
+ */
+static uint32_t GhQuantize(float x)
+{
+    float q = roundf(x * BLOCKSCALE) / BLOCKSCALE;
+    uint32_t v;
+
+    memcpy(&v, &q, 4);
+    return v;
+}
+
+/**
+ * @brief Starts a new, empty block
+ * @version CENG153, serial: 85048a62
+ * @author Devansh Patel
+ * @since 2026-10-19
+ * @param enc encoder
+ * @return void
+ */
+void GhBlockBegin(blockenc_s * enc)
+{
+    int i;
+
+    enc->count = 0;
+    enc->len = BLOCKHDRSZ;
+    enc->acc = 0;
+    enc->nacc = 0;
+    enc->prevdelta = 0;
+    for(i = 0; i < BLOCKCHANNELS; i++)
+    {
+        enc->lead[i] = -1;
+        enc->trail[i] = 0;
+    }
+}
+
+/**
+ * @brief Encodes one reading into the current block
+ * @version CENG153, serial: 85048a62
+ * @author Devansh Patel
+ * @since 2026-10-19
+ * @param enc encoder
+ * @param rd reading to add
+ * @return int 1 if the block is now full, 0 if there is room left,
+ *         -1 if the time jump is too large for this block and it must be finished first
+ */
+int GhBlockAdd(blockenc_s * enc, const reading_s * rd)
+{
+    float ch[BLOCKCHANNELS] = { rd->temperature, rd->humidity, rd->pressure };
+    int64_t t = rd->rtime;
+    int64_t delta, dod;
+    uint32_t v, x;
+    int i, lead, trail, len;
+
+    if(enc->count == 0)
+    {
+        enc->first = t;
+        for(i = 0; i < BLOCKCHANNELS; i++)
+        {
+            enc->prevv[i] = GhQuantize(ch[i]);
+            GhBitPut(enc, enc->prevv[i], 32);
+        }
+        enc->prevt = t;
+        enc->count = 1;
+        return 0;
+    }
+
+    delta = t - enc->prevt;
+    dod = delta - enc->prevdelta;
+    if(dod > INT32_MAX || dod < INT32_MIN)
+    {
+        return -1;
+    }
+    if(dod == 0)
+    {
+        GhBitPut(enc, 0, 1);
+    }
+    else if(dod >= -63 && dod <= 64)
+    {
+        GhBitPut(enc, 2, 2);
+        GhBitPut(enc, dod + 63, 7);
+    }
+    else if(dod >= -255 && dod <= 256)
+    {
+        GhBitPut(enc, 6, 3);
+        GhBitPut(enc, dod + 255, 9);
+    }
+    else if(dod >= -2047 && dod <= 2048)
+    {
+        GhBitPut(enc, 14, 4);
+        GhBitPut(enc, dod + 2047, 12);
+    }
+    else
+    {
+        GhBitPut(enc, 15, 4);
+        GhBitPut(enc, (uint32_t) dod, 32);
+    }
+    enc->prevdelta = delta;
+    enc->prevt = t;
+
+    for(i = 0; i < BLOCKCHANNELS; i++)
+    {
+        v = GhQuantize(ch[i]);
+        x = v ^ enc->prevv[i];
+        enc->prevv[i] = v;
+        if(x == 0)
+        {
+            GhBitPut(enc, 0, 1);
+            continue;
+        }
+        lead = __builtin_clz(x);
+        trail = __builtin_ctz(x);
+        if(enc->lead[i] >= 0 && lead >= enc->lead[i] && trail >= enc->trail[i])
+        {
+            // Meaningful bits fit the previous window
+            len = 32 - enc->lead[i] - enc->trail[i];
+            GhBitPut(enc, 2, 2);
+            GhBitPut(enc, x >> enc->trail[i], len);
+        }
+        else
+        {
+            len = 32 - lead - trail;
+            GhBitPut(enc, 3, 2);
+            GhBitPut(enc, lead, 5);
+            GhBitPut(enc, len - 1, 5);
+            GhBitPut(enc, x >> trail, len);
+            enc->lead[i] = lead;
+            enc->trail[i] = trail;
+        }
+    }
+
+    enc->count++;
+    return enc->count >= BLOCKSAMPLES;
+}
+
+/**
+ * @brief Pads the bit stream and fills in the block header
+ * @version CENG153, serial: 85048a62
+ * @author Devansh Patel
+ * @since 2026-10-19
+ * @param enc encoder holding at least one reading
+ * @return size_t size of the finished block in enc->buf
+ */
+size_t GhBlockFinish(blockenc_s * enc)
+{
+    if(enc->nacc > 0)
+    {
+        GhBitPut(enc, 0, 8 - enc->nacc);
+    }
+    memcpy(enc->buf, BLOCKMAGIC, 4);
+    enc->buf[4] = enc->count;
+    enc->buf[5] = enc->count >> 8;
+    enc->buf[6] = BLOCKVERSION;
+    enc->buf[7] = 0;
+    GhPutLe32(enc->buf + 8, enc->len - BLOCKHDRSZ);
+    GhPutLe64(enc->buf + 12, (uint64_t) enc->first);
+    GhPutLe64(enc->buf + 20, (uint64_t) enc->prevt);
+    return enc->len;
+}
+
+/**
+ * @brief Opens a compressed archive for appending
+ * @version CENG153, serial: 85048a62
+ * @author Devansh Patel
+ * @since 2026-10-19
+ * @param enc encoder to initialise
+ * @param fname archive file name
+ * @return int 1 if the archive is open, 0 otherwise
+ */
+int GhBlockEncOpen(blockenc_s * enc, const char * fname)
+{
+    enc->fd = open(fname, O_WRONLY | O_CREAT | O_APPEND, 0644);
+    if(enc->fd < 0)
+    {
+        fprintf(stderr,"\nCan't open archive %s\n", fname);
+        return 0;
+    }
+    GhBlockBegin(enc);
+    return 1;
+}
+
+/**
+ * @brief Writes the current block, if it holds anything, and starts a new one
+ * @version CENG153, serial: 85048a62
+ * @author Devansh Patel
+ * @since 2026-10-19
+ * @param enc open encoder
+ * @return int 1 on success, 0 on a write error
+ */
+int GhBlockEncFlush(blockenc_s * enc)
+{
+    size_t len;
+    ssize_t n;
+    uint8_t * p = enc->buf;
+
+    if(enc->count == 0)
+    {
+        return 1;
+    }
+    len = GhBlockFinish(enc);
+    GhBlockBegin(enc);
+    while(len > 0)
+    {
+        n = write(enc->fd, p, len);
+        if(n < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        if(n < 0)
+        {
+            fprintf(stderr,"\nArchive write failed\n");
+            return 0;
+        }
+        p += n;
+        len -= n;
+    }
+    return 1;
+}
+
+/**
+ * @brief Streams one reading into the archive, writing a block each time one fills
+ * @version CENG153, serial: 85048a62
+ * @author Devansh Patel
+ * @since 2026-10-19
+ * @param enc open encoder
+ * @param rd reading to archive
+ * @return int 1 on success, 0 on a write error
+ */
+int GhBlockEncAppend(blockenc_s * enc, const reading_s * rd)
+{
+    int full = GhBlockAdd(enc, rd);
+
+    if(full < 0)
+    {
+        if(!GhBlockEncFlush(enc))
+        {
+            return 0;
+        }
+        full = GhBlockAdd(enc, rd);
+    }
+    return full ? GhBlockEncFlush(enc) : 1;
+}
+
+/**
+ * @brief Writes the partial block and closes the archive
+ * @version CENG153, serial: 85048a62
+ * @author Devansh Patel
+ * @since 2026-10-19
+ * @param enc open encoder
+ * @return int 1 on success, 0 on a write error
+ */
+int GhBlockEncClose(blockenc_s * enc)
+{
+    int ok = GhBlockEncFlush(enc);
+
+    close(enc->fd);
+    enc->fd = -1;
+    return ok;
+}
+
+/**
+ * @brief Validates a block header
+ * @version CENG153, serial: 85048a62
+ * @author Devansh Patel
+ * @since 2026-10-19
+ * @param blk start of the block
+ * @param len bytes available, at least BLOCKHDRSZ
+ * @param info count, total size and time span of the block
+ * @return int 1 if the header is valid, 0 otherwise
+ */
+int GhBlockInfo(const uint8_t * blk, size_t len, blockinfo_s * info)
+{
+    if(len < BLOCKHDRSZ || memcmp(blk, BLOCKMAGIC, 4) != 0 || blk[6] != BLOCKVERSION)
+    {
+        return 0;
+    }
+    info->count = blk[4] | blk[5] << 8;
+    info->size = BLOCKHDRSZ + GhGetLe32(blk + 8);
+    info->first = (int64_t) GhGetLe64(blk + 12);
+    info->last = (int64_t) GhGetLe64(blk + 20);
+    return info->count > 0 && info->count <= BLOCKSAMPLES && info->size <= BLOCKMAXSZ;
+}
+
+/**
+ * @brief Decompresses one block
+ * @version CENG153, serial: 85048a62
+ * @author Devansh Patel
+ * @since 2026-10-19
+ * @param blk start of the block
+ * @param len bytes available
+ * @param out decoded readings
+ * @param max capacity of out
+ * @return int number of readings decoded, -1 if the block is damaged
+ */
+int GhBlockDecode(const uint8_t * blk, size_t len, reading_s * out, int max)
+{
+    blockinfo_s info;
+    const uint8_t * p;
+    const uint8_t * end;
+    uint64_t acc = 0;
+    int nacc = 0;
+    int64_t t, delta = 0, dod;
+    uint32_t prevv[BLOCKCHANNELS], x;
+    float ch[BLOCKCHANNELS];
+    int lead[BLOCKCHANNELS] = {0}, trail[BLOCKCHANNELS] = {0};
+    int i, c, n, len2;
+
+    if(!GhBlockInfo(blk, len, &info) || info.size > len)
+    {
+        return -1;
+    }
+    p = blk + BLOCKHDRSZ;
+    end = blk + info.size;
+    n = info.count < max ? info.count : max;
+
+// Pull n (<= 32) bits from the stream, zero filled past the end
+#define GETBITS(v, nb) \
+    do { \
+        while(nacc < (nb)) \
+        { \
+            acc = (acc << 8) | (p < end ? *p++ : 0); \
+            nacc += 8; \
+        } \
+        nacc -= (nb); \
+        (v) = (uint32_t) (acc >> nacc) & (uint32_t) ((1ULL << (nb)) - 1); \
+    } while(0)
+
+    t = info.first;
+    for(i = 0; i < n; i++)
+    {
+        if(i > 0)
+        {
+            GETBITS(x, 1);
+            if(x == 0)
+            {
+                dod = 0;
+            }
+            else
+            {
+                GETBITS(x, 1);
+                if(x == 0)
+                {
+                    GETBITS(x, 7);
+                    dod = (int64_t) x - 63;
+                }
+                else
+                {
+                    GETBITS(x, 1);
+                    if(x == 0)
+                    {
+                        GETBITS(x, 9);
+                        dod = (int64_t) x - 255;
+                    }
+                    else
+                    {
+                        GETBITS(x, 1);
+                        if(x == 0)
+                        {
+                            GETBITS(x, 12);
+                            dod = (int64_t) x - 2047;
+                        }
+                        else
+                        {
+                            GETBITS(x, 32);
+                            dod = (int32_t) x;
+                        }
+                    }
+                }
+            }
+            delta += dod;
+            t += delta;
+        }
+
+        for(c = 0; c < BLOCKCHANNELS; c++)
+        {
+            if(i == 0)
+            {
+                GETBITS(prevv[c], 32);
+            }
+            else
+            {
+                GETBITS(x, 1);
+                if(x != 0)
+                {
+                    GETBITS(x, 1);
+                    if(x != 0)
+                    {
+                        GETBITS(lead[c], 5);
+                        GETBITS(len2, 5);
+                        trail[c] = 32 - lead[c] - (len2 + 1);
+                        if(trail[c] < 0)
+                        {
+                            return -1;
+                        }
+                    }
+                    len2 = 32 - lead[c] - trail[c];
+                    GETBITS(x, len2);
+                    prevv[c] ^= x << trail[c];
+                }
+            }
+            memcpy(&ch[c], &prevv[c], 4);
+        }
+        out[i].rtime = (time_t) t;
+        out[i].temperature = ch[0];
+        out[i].humidity = ch[1];
+        out[i].pressure = ch[2];
+    }
+#undef GETBITS
+
+    return n;
+}
+
+/**
+ * @brief Reads the next whole block from an archive
+ * @version CENG153, serial: 85048a62
+ * @author Devansh Patel
+ * @since 2026-10-19
+ * @param fd archive positioned at a block boundary
+ * @param blk buffer for the block
+ * @param cap size of blk, BLOCKMAXSZ is always enough
+ * @param info header of the block read
+ * @return int 1 if a block was read, 0 at end of file, -1 if the archive is damaged
+ */
+int GhBlockReadNext(int fd, uint8_t * blk, size_t cap, blockinfo_s * info)
+{
+    ssize_t n;
+
+    n = read(fd, blk, BLOCKHDRSZ);
+    if(n == 0)
+    {
+        return 0;
+    }
+    if(n != BLOCKHDRSZ || !GhBlockInfo(blk, n, info) || info->size > cap)
+    {
+        return -1;
+    }
+    n = read(fd, blk + BLOCKHDRSZ, info->size - BLOCKHDRSZ);
+    return n == (ssize_t) (info->size - BLOCKHDRSZ) ? 1 : -1;
+}
@@ -0,0 +1,60 @@
+/** @brief Compressed time-series block constants, structures, function prototypes
+*   @file ghblock.h
+*/
+
+#ifndef GHBLOCK_H
+#define GHBLOCK_H
+
+// Includes
+#include <stdint.h>
+#include <stddef.h>
+#include "ghcontrol.h"
+
+// Constants
+#define BLOCKMAGIC "GHZB"
+#define BLOCKVERSION 1
+#define BLOCKHDRSZ 28
+#define BLOCKSAMPLES 1024
+#define BLOCKCHANNELS 3
+#define BLOCKSCALE 10.0f
+#define BLOCKSAMPLEMAX 22
+#define BLOCKMAXSZ (BLOCKHDRSZ + BLOCKSAMPLES * BLOCKSAMPLEMAX)
+
+// Structures
+typedef struct blockenc
+{
+    int fd;
+    int count;
+    size_t len;
+    uint64_t acc;
+    int nacc;
+    int64_t first;
+    int64_t prevt;
+    int64_t prevdelta;
+    uint32_t prevv[BLOCKCHANNELS];
+    int lead[BLOCKCHANNELS];
+    int trail[BLOCKCHANNELS];
+    uint8_t buf[BLOCKMAXSZ];
+} blockenc_s;
+
+typedef struct blockinfo
+{
+    int count;
+    size_t size;
+    int64_t first;
+    int64_t last;
+} blockinfo_s;
+
+//@cond INTERNAL
+void GhBlockBegin(blockenc_s * enc);
+int GhBlockAdd(blockenc_s * enc, const reading_s * rd);
+size_t GhBlockFinish(blockenc_s * enc);
+int GhBlockEncOpen(blockenc_s * enc, const char * fname);
+int GhBlockEncAppend(blockenc_s * enc, const reading_s * rd);
+int GhBlockEncFlush(blockenc_s * enc);
+int GhBlockEncClose(blockenc_s * enc);
+int GhBlockInfo(const uint8_t * blk, size_t len, blockinfo_s * info);
+int GhBlockDecode(const uint8_t * blk, size_t len, reading_s * out, int max);
+int GhBlockReadNext(int fd, uint8_t * blk, size_t cap, blockinfo_s * info);
+//@endcond
+#endif
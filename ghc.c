@@ -10,50 +10,234 @@
 */
 
 #include "ghcontrol.h"
+#include "ghalarm.h"
+#include "ghconfig.h"
+#include "ghlog.h"
+#include "ghrollup.h"
+#include "ghring.h"
+#include "ghpart.h"
+#include "ghshm.h"
+#include "ghnotify.h"
+#include "ghanim.h"
+#include "ghtrend.h"
+#include "ghdash.h"
+#include "ghstream.h"
+#include "ghwatch.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <unistd.h> // for sleep function
 #include <string.h>
+#include <getopt.h>
+#include <signal.h>
 
-int main(void)
+int main(int argc, char * argv[])
 {
+#if LOGTEXT
     int logged;
+#endif
+	static const struct option options[] = {
+		{"display", required_argument, NULL, 'd'},
+		{"joystick", required_argument, NULL, 'j'},
+		{"output", required_argument, NULL, 'o'},
+		{NULL, 0, NULL, 0}
+	};
+	const char * display = "fb";
+	const char * joystick = NULL;
+	const char * output = "text";
+	int dashboard, streaming;
+	int opt, key, trendview = 0;
+	char text[ANIMTEXTSZ];
 	setpoint_s sets = {0};
 	control_s ctrl = {0};
 	reading_s creadings = {0};
-	alarmlimit_s alimits = { 0 };
-    //alarm_s warn[NALARMS];
+	const config_s * cfg;
+	rollup_s rollups;
+	ringlog_s ring;
+	partlog_s parts;
+	ghstate_s state = {0};
+	shmseg_s * shm;
+	alarmtable_s alarms = {0};
+	alarmrules_s rules = {0};
+	float channels[ALARMCHANNELS];
+	int journal;
+	notifier_s notify;
+	anim_s anim;
+	trend_s trend;
+	dash_s dash;
+	stream_s stream;
+	struct timespec cycle = {0};
 
-    alarm_s * arecord;
-    arecord = (alarm_s *) calloc(1,sizeof(alarm_s));
-    if(arecord == NULL)
-    {
-        fprintf(stderr,"\nCannot allocate memory\n");
-        return EXIT_FAILURE;
-    }
+	while((opt = getopt_long(argc, argv, "d:j:o:", options, NULL)) != -1)
+	{
+		switch(opt)
+		{
+		case 'd':
+			display = optarg;
+			break;
+		case 'j':
+			joystick = optarg;
+			break;
+		case 'o':
+			output = optarg;
+			break;
+		default:
+			fprintf(stderr,"\nUsage: %s [--display=fb|memory|ppm:DIR|ansi] [--joystick=dev|none|script:FILE] [--output=text|dashboard|jsonl|binary]\n", argv[0]);
+			return EXIT_FAILURE;
+		}
+	}
+	dashboard = strcmp(output, "dashboard") == 0;
+	streaming = strcmp(output, "jsonl") == 0 || strcmp(output, "binary") == 0;
+	if(!dashboard && !streaming && strcmp(output, "text") != 0)
+	{
+		fprintf(stderr,"\nUnknown output %s, expected text, dashboard, jsonl or binary\n", output);
+		return EXIT_FAILURE;
+	}
+	// Taken before anything is printed, stdout then carries nothing but records
+	if(streaming && !GhStreamOpen(&stream, output))
+	{
+		return EXIT_FAILURE;
+	}
+	// Both want the terminal
+	if(dashboard && strcmp(display, "ansi") == 0)
+	{
+		fprintf(stderr,"\nThe ansi display cannot be used with the dashboard\n");
+		return EXIT_FAILURE;
+	}
 
+	// Blocked before any thread starts, the loop below then ends on the cycle they arrive in
+	GhWatchQuit(SIGINT);
+	GhWatchQuit(SIGTERM);
 	GhControllerInit();
+	GhRollupInit(&rollups);
+	GhRingOpen(&ring, RINGFILE, RINGPAGES);
+	GhPartOpen(&parts);
+	shm = GhShmOpen();
+	journal = GhAlarmJournalOpen(ALARMJOURNAL);
+	GhNotifyOpen(&notify, NOTIFYFILE);
 	struct fb_t *fb;
-	fb = ShInit(fb);
+	struct sensehat_t hat;
+	struct compositor_t panel;
+	if(!ShOpen(&hat, display, joystick))
+	{
+		return EXIT_FAILURE;
+	}
+	ShCompositorInit(&panel, &hat);
+	if(dashboard && !GhDashOpen(&dash))
+	{
+		return EXIT_FAILURE;
+	}
+	// Scenes are drawn here and animated onto the panel between cycles
+	GhAnimInit(&anim, &panel);
+	GhTrendInit(&trend);
+	fb = &anim.scene;
+	clock_gettime(CLOCK_MONOTONIC, &cycle);
 
-	while(1)
+	while(!GhWatchQuitting())
 	{
+		// Nothing from the previous cycle's configuration is still held here
+		GhConfigQuiescent();
+		cfg = GhConfigGet();
+#if LOGTEXT
         logged = GhLogData("ghdata.txt", creadings);
+#endif
 	    sets = GhSetTargets();
-	    alimits = GhSetAlarmLimits();
 		creadings = GhGetReadings(); //commented out
+		GhPartAppend(&parts, &creadings);
+		GhRollupUpdate(&rollups, creadings);
+		if(ring.fd >= 0)
+		{
+			GhRingAppend(&ring, &creadings);
+		}
 		ctrl = GhSetControls(sets, creadings);
-		arecord = GhSetAlarms(arecord, alimits, creadings);
-		GhDisplayAll (creadings, sets, fb);
-		GhDisplayReadings(creadings);
-		GhDisplayTargets(sets);
-		GhDisplayControls(ctrl);
-		GhDisplayAlarms(arecord);
-		GhDelay(GHUPDATE);
+		// Alarms raised by rules that changed are cleared before the new rules are checked
+		if(GhAlarmRulesUpdate(&rules, cfg->alimits) && GhAlarmTableRules(&alarms, &rules, creadings.rtime) > 0)
+		{
+			GhAlarmJournal(journal, &alarms);
+			GhNotifyPost(&notify, &alarms);
+		}
+		GhAlarmChannels(creadings, channels);
+		if(GhAlarmTableUpdate(&alarms, &rules, channels, creadings.rtime, cfg->alimits.debounce) > 0)
+		{
+			GhAlarmJournal(journal, &alarms);
+			GhNotifyPost(&notify, &alarms);
+		}
+		state.readings = creadings;
+		state.setpoints = sets;
+		state.controls = ctrl;
+		state.alarms = alarms.codes;
+		state.cycles++;
+		GhShmPublish(shm, &state);
+		// Enter on the joystick scrolls the readings, left and right switch between bars and history
+		while((key = ShJoystick(&hat)) >= 0)
+		{
+			if(key == KEY_ENTER)
+			{
+				snprintf(text, sizeof(text), "T %.1fC H %.0f%% P %.0fmb", creadings.temperature, creadings.humidity, creadings.pressure);
+				GhAnimScroll(&anim, text, WHITE);
+			}
+			else if(key == KEY_LEFT || key == KEY_RIGHT)
+			{
+				trendview = !trendview;
+			}
+		}
+		ShCompositorRotate(&panel, cfg->map.rotation);
+		GhTrendUpdate(&trend, creadings);
+		if(trendview)
+		{
+			GhDisplayTrend(&trend, fb);
+		}
+		else
+		{
+			GhDisplayAll (creadings, sets, fb);
+		}
+		GhAnimScene(&anim);
+		GhAnimAlarms(&anim, &alarms);
+		if(dashboard)
+		{
+			GhDashUpdate(&dash, creadings, sets, ctrl, &alarms, &anim.stats);
+		}
+		else if(streaming)
+		{
+			GhStreamRecord(&stream, &state);
+			GhStreamFlush(&stream);
+		}
+		else
+		{
+			GhDisplayReadings(creadings);
+			GhDisplayTargets(sets);
+			GhDisplayControls(ctrl);
+			GhDisplayAlarms(GhAlarmList(&alarms));
+			GhAnimDisplayStats(&anim);
+		}
+		// The display animates until the next cycle is due
+		GhAnimNextCycle(&cycle, cfg->update);
+		// cfg is not used again this cycle, a reload need not wait out the animation
+		GhConfigOffline();
+		GhAnimRun(&anim, &cycle);
 	}
 	//fprintf(stdout,"Press ENTER to continue...");
 	//fgetc(stdin);
 
+	// Give the terminal back first so any error below is readable
+	if(dashboard)
+	{
+		GhDashClose(&dash);
+	}
+	// Write out everything still held in memory
+	GhRollupFlush(&rollups);
+	GhRingClose(&ring);
+	GhPartClose(&parts);
+	GhNotifyClose(&notify);
+	if(journal >= 0)
+	{
+		close(journal);
+	}
+	if(streaming)
+	{
+		GhStreamClose(&stream);
+	}
+	GhShmClose(shm);
+	GhWatchStop();
 	return EXIT_SUCCESS;
 }
 
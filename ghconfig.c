@@ -0,0 +1,326 @@
+/** @brief Runtime configuration
+*   @file ghconfig.c
+*   Alarm limits, display ranges and the update period are read from
+*   CONFIGFILE into an immutable snapshot, falling back to the compiled-in
+*   defaults for anything the file leaves out. Readers use the current
+*   snapshot through an atomically swapped pointer without locking.
+*
+*   A reload, run by the watcher thread on a file change or SIGHUP,
+*   publishes a new snapshot and then waits for a grace period before it
+*   frees the old one. Each reader thread reports a quiescent state,
+*   holding no snapshot pointer, once per cycle with GhConfigQuiescent.
+*   The grace period ends when every reader has done so since the swap.
+*   A thread about to block for a long time calls GhConfigOffline so it
+*   does not hold up reloads.
+*
+*   File format: one "key = value" per line, # starts a comment.
+*/
+
+#include "ghconfig.h"
+#include "ghwatch.h"
+#include <math.h>
+#include <signal.h>
+#include <stddef.h>
+#include <unistd.h>
+
+// Offset that puts a display range's low end a bar height of NUMPTS * 0.05 above zero
+#define DISPOFF(ls, us) (NUMPTS * 0.05 - NUMPTS / ((us) - (ls)) * (ls))
+
+// Compiled-in defaults, also the snapshot in use until GhConfigInit
+static config_s configboot =
+{
+    GHUPDATE,
+    {UPPERATEMP, LOWERATEMP, UPPERAHUMID, LOWERAHUMID, UPPERAPRESS, LOWERAPRESS,
+     HYSTATEMP, HYSTAHUMID, HYSTAPRESS, ALARMDEBOUNCE},
+    USTEMP, LSTEMP, USHUMID, LSHUMID, USPRESS, LSPRESS,
+    NUMPTS / (USTEMP - LSTEMP), NUMPTS / (USHUMID - LSHUMID), NUMPTS / (USPRESS - LSPRESS),
+    {{NUMPTS / (USTEMP - LSTEMP), NUMPTS / (USHUMID - LSHUMID), NUMPTS / (USPRESS - LSPRESS)},
+     {DISPOFF(LSTEMP, USTEMP), DISPOFF(LSHUMID, USHUMID), DISPOFF(LSPRESS, USPRESS)}, 0}
+};
+
+static const struct
+{
+    const char * key;
+    size_t off;
+} configkeys[] =
+{
+    {"temperature_alarm_high", offsetof(config_s, alimits.hight)},
+    {"temperature_alarm_low", offsetof(config_s, alimits.lowt)},
+    {"humidity_alarm_high", offsetof(config_s, alimits.highh)},
+    {"humidity_alarm_low", offsetof(config_s, alimits.lowh)},
+    {"pressure_alarm_high", offsetof(config_s, alimits.highp)},
+    {"pressure_alarm_low", offsetof(config_s, alimits.lowp)},
+    {"temperature_hysteresis", offsetof(config_s, alimits.hystt)},
+    {"humidity_hysteresis", offsetof(config_s, alimits.hysth)},
+    {"pressure_hysteresis", offsetof(config_s, alimits.hystp)},
+    {"alarm_debounce_s", offsetof(config_s, alimits.debounce)},
+    {"temperature_display_max", offsetof(config_s, ustemp)},
+    {"temperature_display_min", offsetof(config_s, lstemp)},
+    {"humidity_display_max", offsetof(config_s, ushumid)},
+    {"humidity_display_min", offsetof(config_s, lshumid)},
+    {"pressure_display_max", offsetof(config_s, uspress)},
+    {"pressure_display_min", offsetof(config_s, lspress)},
+};
+
+static config_s * configcur = &configboot;
+static unsigned long configepoch = 0;
+static unsigned long configseen[CONFIGREADERS];
+static int configonline[CONFIGREADERS];
+static int configreaders = 0;
+static __thread int configreader = -1;
+
+/**
+ * @brief Registers the calling thread as a reader and marks it online
+ * @return int reader slot, -1 if there are more than CONFIGREADERS readers
+ */
+static int GhConfigOnline(void)
+{
+    if(configreader < 0)
+    {
+        configreader = __atomic_fetch_add(&configreaders, 1, __ATOMIC_SEQ_CST);
+        if(configreader >= CONFIGREADERS)
+        {
+            fprintf(stderr,"\nToo many configuration readers\n");
+        }
+    }
+    if(configreader >= CONFIGREADERS)
+    {
+        return -1;
+    }
+    __atomic_store_n(&configseen[configreader], __atomic_load_n(&configepoch, __ATOMIC_SEQ_CST), __ATOMIC_SEQ_CST);
+    __atomic_store_n(&configonline[configreader], 1, __ATOMIC_SEQ_CST);
+    return configreader;
+}
+
+/**
+ * @brief Waits until every online reader has passed a quiescent state since the last swap
+ * @return void
+ */
+static void GhConfigSync(void)
+{
+    unsigned long epoch;
+    int i, n;
+
+    epoch = __atomic_add_fetch(&configepoch, 1, __ATOMIC_SEQ_CST);
+    n = __atomic_load_n(&configreaders, __ATOMIC_SEQ_CST);
+    for(i = 0; i < n && i < CONFIGREADERS; i++)
+    {
+        while(__atomic_load_n(&configonline[i], __ATOMIC_SEQ_CST) &&
+              (long) (__atomic_load_n(&configseen[i], __ATOMIC_SEQ_CST) - epoch) < 0)
+        {
+            usleep(1000);
+        }
+    }
+}
+
+/**
+ * @brief Works out the display scale factors of a snapshot and folds them into the display map
+ * @param cfg snapshot
+ * @return void
+ */
+static void GhConfigScale(config_s * cfg)
+{
+    cfg->tscale = NUMPTS / (cfg->ustemp - cfg->lstemp);
+    cfg->hscale = NUMPTS / (cfg->ushumid - cfg->lshumid);
+    cfg->pscale = NUMPTS / (cfg->uspress - cfg->lspress);
+    cfg->map.mul[0] = cfg->tscale;
+    cfg->map.mul[1] = cfg->hscale;
+    cfg->map.mul[2] = cfg->pscale;
+    cfg->map.off[0] = NUMPTS * 0.05 - cfg->tscale * cfg->lstemp;
+    cfg->map.off[1] = NUMPTS * 0.05 - cfg->hscale * cfg->lshumid;
+    cfg->map.off[2] = NUMPTS * 0.05 - cfg->pscale * cfg->lspress;
+}
+
+/**
+ * @brief Parses and validates a configuration file
+ * @version CENG153, serial: 85048a62
+ * @author Devansh Patel
+ * @since 2026-10-19
+ * @param fname configuration file name
+ * @param cfg snapshot to fill, defaults for keys the file leaves out or if it does not exist
+ * @return int 1 if cfg is valid, 0 if the file has errors
+ */
+int GhConfigLoad(const char * fname, config_s * cfg)
+{
+    char line[CONFIGLINESZ], key[CONFIGKEYSZ], extra;
+    alarmlimit_s * al = &cfg->alimits;
+    size_t i;
+    double v;
+    int lineno = 0, ok = 1;
+    FILE *fp;
+
+    *cfg = configboot;
+    fp = fopen(fname,"r");
+    if(fp == NULL)
+    {
+        return 1;
+    }
+    while(fgets(line, sizeof(line), fp) != NULL)
+    {
+        lineno++;
+        line[strcspn(line, "#")] = '\0';
+        if(sscanf(line, " %c", &extra) != 1)
+        {
+            continue;
+        }
+        if(sscanf(line, " %31[a-z_] = %lf %c", key, &v, &extra) != 2 || !isfinite(v))
+        {
+            fprintf(stderr,"\n%s line %d: expected key = number\n", fname, lineno);
+            ok = 0;
+            continue;
+        }
+        if(strcmp(key, "update_ms") == 0)
+        {
+            cfg->update = (v >= CONFIGUPDATEMIN && v <= CONFIGUPDATEMAX) ? (int) v : -1;
+            continue;
+        }
+        if(strcmp(key, "display_rotation") == 0)
+        {
+            cfg->map.rotation = (v == 0 || v == 90 || v == 180 || v == 270) ? (int) v : -1;
+            continue;
+        }
+        for(i = 0; i < sizeof(configkeys) / sizeof(configkeys[0]); i++)
+        {
+            if(strcmp(key, configkeys[i].key) == 0)
+            {
+                *(float *) ((char *) cfg + configkeys[i].off) = v;
+                break;
+            }
+        }
+        if(i == sizeof(configkeys) / sizeof(configkeys[0]))
+        {
+            fprintf(stderr,"\n%s line %d: unknown key %s\n", fname, lineno, key);
+            ok = 0;
+        }
+    }
+    fclose(fp);
+
+    if(cfg->update < 0)
+    {
+        fprintf(stderr,"\n%s: update_ms must be %d to %d\n", fname, CONFIGUPDATEMIN, CONFIGUPDATEMAX);
+        ok = 0;
+    }
+    if(cfg->map.rotation < 0)
+    {
+        fprintf(stderr,"\n%s: display_rotation must be 0, 90, 180 or 270\n", fname);
+        ok = 0;
+    }
+    if(al->lowt >= al->hight || al->lowh >= al->highh || al->lowp >= al->highp ||
+       cfg->lstemp >= cfg->ustemp || cfg->lshumid >= cfg->ushumid || cfg->lspress >= cfg->uspress)
+    {
+        fprintf(stderr,"\n%s: every low limit must be below its high limit\n", fname);
+        ok = 0;
+    }
+    if(al->hystt < 0 || al->hysth < 0 || al->hystp < 0 || al->debounce < 0 || al->debounce > CONFIGDEBOUNCEMAX)
+    {
+        fprintf(stderr,"\n%s: hysteresis must not be negative, debounce must be 0 to %d s\n", fname, CONFIGDEBOUNCEMAX);
+        ok = 0;
+    }
+    GhConfigScale(cfg);
+    return ok;
+}
+
+/**
+ * @brief Loads the configuration file again and swaps it in if it is valid
+ * @version CENG153, serial: 85048a62
+ * @author Devansh Patel
+ * @since 2026-10-19
+ * @return void
+ */
+void GhConfigReload(void)
+{
+    config_s * fresh;
+    config_s * old;
+
+    fresh = malloc(sizeof(config_s));
+    if(fresh == NULL)
+    {
+        fprintf(stderr,"\nCannot allocate memory\n");
+        return;
+    }
+    if(!GhConfigLoad(CONFIGFILE, fresh))
+    {
+        fprintf(stderr,"\nKeeping the current configuration\n");
+        free(fresh);
+        return;
+    }
+    old = __atomic_exchange_n(&configcur, fresh, __ATOMIC_SEQ_CST);
+    GhConfigSync();
+    if(old != &configboot)
+    {
+        free(old);
+    }
+}
+
+/**
+ * @brief Loads the configuration and arranges for it to reload on change or SIGHUP
+ * @version CENG153, serial: 85048a62
+ * @author Devansh Patel
+ * @since 2026-10-19
+ * @return int 1 if the file was valid, 0 if the defaults are in use
+ */
+int GhConfigInit(void)
+{
+    config_s * cfg;
+    int id, ok;
+
+    cfg = malloc(sizeof(config_s));
+    ok = cfg != NULL && GhConfigLoad(CONFIGFILE, cfg);
+    if(ok)
+    {
+        __atomic_store_n(&configcur, cfg, __ATOMIC_SEQ_CST);
+    }
+    else
+    {
+        fprintf(stderr,"\nUsing the default configuration\n");
+        free(cfg);
+    }
+
+    id = GhWatchAdd(CONFIGFILE);
+    GhWatchCall(id, GhConfigReload);
+    GhWatchSignal(id, SIGHUP);
+    return ok;
+}
+
+/**
+ * @brief Returns the current configuration snapshot
+ * @version CENG153, serial: 85048a62
+ * @author Devansh Patel
+ * @since 2026-10-19
+ * @return const config_s* snapshot, valid until the calling thread's next GhConfigQuiescent or GhConfigOffline
+ */
+const config_s * GhConfigGet(void)
+{
+    if(configreader < 0 || (configreader < CONFIGREADERS && !configonline[configreader]))
+    {
+        GhConfigOnline();
+    }
+    return __atomic_load_n(&configcur, __ATOMIC_SEQ_CST);
+}
+
+/**
+ * @brief Reports that the calling thread holds no configuration snapshot
+ * @version CENG153, serial: 85048a62
+ * @author Devansh Patel
+ * @since 2026-10-19
+ * @return void
+ */
+void GhConfigQuiescent(void)
+{
+    GhConfigOnline();
+}
+
+/**
+ * @brief Takes the calling thread out of grace periods until its next GhConfigGet
+ * @version CENG153, serial: 85048a62
+ * @author Devansh Patel
+ * @since 2026-10-19
+ * @return void
+ */
+void GhConfigOffline(void)
+{
+    if(configreader >= 0 && configreader < CONFIGREADERS)
+    {
+        __atomic_store_n(&configonline[configreader], 0, __ATOMIC_SEQ_CST);
+    }
+}
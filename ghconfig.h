@@ -0,0 +1,52 @@
+/** @brief Runtime configuration constants, structures, function prototypes
+*   @file ghconfig.h
+*/
+
+#ifndef GHCONFIG_H
+#define GHCONFIG_H
+
+// Includes
+#include "ghcontrol.h"
+
+// Constants
+#define CONFIGFILE "ghc.conf"
+#define CONFIGLINESZ 128
+#define CONFIGKEYSZ 32
+#define CONFIGREADERS 8
+#define CONFIGUPDATEMIN 100
+#define CONFIGUPDATEMAX 60000
+#define CONFIGDEBOUNCEMAX 3600
+
+// Structures
+typedef struct dispmap
+{
+    float mul[SENSORS];
+    float off[SENSORS];
+    int rotation;
+} dispmap_s;
+
+typedef struct config
+{
+    int update;
+    alarmlimit_s alimits;
+    float ustemp;
+    float lstemp;
+    float ushumid;
+    float lshumid;
+    float uspress;
+    float lspress;
+    float tscale;
+    float hscale;
+    float pscale;
+    dispmap_s map;
+} config_s;
+
+//@cond INTERNAL
+int GhConfigInit(void);
+int GhConfigLoad(const char * fname, config_s * cfg);
+void GhConfigReload(void);
+const config_s * GhConfigGet(void);
+void GhConfigQuiescent(void);
+void GhConfigOffline(void);
+//@endcond
+#endif
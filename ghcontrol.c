@@ -3,6 +3,15 @@
 */
 
 #include "ghcontrol.h"
+#include "ghalarm.h"
+#include "ghconfig.h"
+#include "ghlog.h"
+#include "ghsched.h"
+#include "ghwatch.h"
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
 // Alarm Message Array
 /**
@@ -15,6 +24,10 @@
 
 const char alarmnames[NALARMS][ALARMNMSZ] = {"No Alarms","High Temperature","Low Temperature","High Humidity", "Low Humidity","HighPressure","Low Pressure"};
 
+// Watch ids of the setpoints and schedule files, -1 reads them every cycle
+static int setwatch = -1;
+static int schedwatch = -1;
+
 /**
  * @brief Logs sensor data to a file
  * @version CENG153, serial: 85048a62
@@ -109,6 +122,10 @@ void GhControllerInit()
 {
 	srand((unsigned) time(NULL));
 	GhDisplayHeader("Devansh Nileshkumar Patel");
+	setwatch = GhWatchAdd(SETPOINTFILE);
+	schedwatch = GhWatchAdd(SCHEDFILE);
+	GhConfigInit();
+	GhWatchStart();
 }
 
 /**
@@ -141,6 +158,33 @@ void GhDisplayReadings(reading_s rdata)
 {
 	fprintf(stdout, "\nUnit: %LX %s Readings\tT: %5.1fC\tH: %5.1f%\tP: %6.1fmb\n", ShGetSerial (), ctime(&rdata.rtime), rdata.temperature, rdata.humidity, rdata.pressure);
 }
+/**
+ * @brief Reads and validates the setpoints file
+ * @param fname setpoints file name
+ * @param spts setpoints read, the defaults if the file does not exist or holds none
+ * @return int 1 if spts is valid, 0 if the file is damaged and must be ignored
+ */
+static int GhLoadSetpoints(const char * fname, setpoint_s * spts)
+{
+    setpoint_s fresh = {0};
+    int rv;
+
+    spts->temperature = STEMP;
+    spts->humidity = SHUMID;
+    rv = GhReadSetpoints(fname, &fresh);
+    if(rv < 0 || (rv > 0 && (!(fresh.temperature >= LSTEMP && fresh.temperature <= USTEMP) ||
+       !(fresh.humidity >= LSHUMID && fresh.humidity <= USHUMID))))
+    {
+        fprintf(stderr,"\nIgnoring invalid %s, setpoints unchanged\n", fname);
+        return 0;
+    }
+    if(rv > 0)
+    {
+        *spts = fresh;
+    }
+    return 1;
+}
+
 /**
  * @brief Displays the current sensor readings
  * @version CENG153, serial: 85048a62
@@ -151,11 +195,25 @@ void GhDisplayReadings(reading_s rdata)
  */
 setpoint_s GhSetTargets()
 {
-    setpoint_s cpoints = GhRetrieveSetpoints("setpoints.dat");
-    if(cpoints.temperature == 0)
+    static setpoint_s cpoints = {STEMP, SHUMID};
+    static schedule_s * sched = NULL;
+    schedule_s * nsched;
+    setpoint_s fresh;
+
+    // Only read the files again once the watcher has seen them change
+    if(GhWatchChanged(schedwatch) && GhScheduleLoad(SCHEDFILE, &nsched))
+    {
+        // The whole table is replaced at once, never a mix of old and new
+        free(sched);
+        sched = nsched;
+    }
+    if(sched != NULL)
+    {
+        return GhScheduleTarget(sched, time(NULL));
+    }
+    if(GhWatchChanged(setwatch) && GhLoadSetpoints(SETPOINTFILE, &fresh))
     {
-        cpoints.temperature = STEMP;
-        cpoints.humidity = SHUMID;
+        cpoints = fresh;
     }
     return cpoints;
 }
@@ -264,6 +322,115 @@ reading_s GhGetReadings(void)
     return now;
 }
 
+/**
+ * @brief Serializes setpoints into a versioned, checksummed record
+ * @version CENG153, serial: 85048a62
+ * @author Devansh Patel
+ * @since 2026-10-19
+ * @param buf destination, SETRECSZ bytes
+ * @param spts setpoints
+ * @return size_t record size
+ */
+size_t GhEncodeSetpoints(uint8_t * buf, setpoint_s spts)
+{
+    float fields[SETFIELDS] = {spts.temperature, spts.humidity};
+    uint32_t f;
+    int i;
+
+    memcpy(buf, SETMAGIC, 4);
+    buf[4] = SETVERSION & 0xff;
+    buf[5] = SETVERSION >> 8;
+    buf[6] = SETFIELDS & 0xff;
+    buf[7] = SETFIELDS >> 8;
+    for(i = 0; i < SETFIELDS; i++)
+    {
+        memcpy(&f, &fields[i], 4);
+        GhPutLe32(buf + SETHDRSZ + 4 * i, f);
+    }
+    GhPutLe32(buf + SETRECSZ - 4, GhCrc32c(0, buf, SETRECSZ - 4));
+    return SETRECSZ;
+}
+
+/**
+ * @brief Checks and deserializes a setpoint record
+ * @version CENG153, serial: 85048a62
+ * @author Devansh Patel
+ * @since 2026-10-19
+ * @param buf record
+ * @param len record size
+ * @param spts setpoints, defaults for fields an older record does not have
+ * @return int 1 if spts is valid, 0 if the record holds no setpoints, -1 if it is damaged
+ */
+int GhDecodeSetpoints(const uint8_t * buf, size_t len, setpoint_s * spts)
+{
+    float fields[SETFIELDS] = {STEMP, SHUMID};
+    uint32_t f;
+    unsigned nfields, i;
+
+    // Files written before the record format were the raw struct in host layout, 0 meaning not set
+    if(len == sizeof(setpoint_s) && memcmp(buf, SETMAGIC, 4) != 0)
+    {
+        memcpy(spts, buf, sizeof(setpoint_s));
+        return spts->temperature != 0;
+    }
+
+    // Any version is readable: later versions only append fields, which are skipped here
+    if(len < SETHDRSZ + 4 || memcmp(buf, SETMAGIC, 4) != 0 || (buf[4] | buf[5] << 8) == 0)
+    {
+        return -1;
+    }
+    nfields = buf[6] | buf[7] << 8;
+    if(len != SETHDRSZ + 4 * (size_t) nfields + 4 || GhGetLe32(buf + len - 4) != GhCrc32c(0, buf, len - 4))
+    {
+        return -1;
+    }
+    for(i = 0; i < nfields && i < SETFIELDS; i++)
+    {
+        f = GhGetLe32(buf + SETHDRSZ + 4 * i);
+        memcpy(&fields[i], &f, 4);
+    }
+    spts->temperature = fields[0];
+    spts->humidity = fields[1];
+    return nfields > 0;
+}
+
+/**
+ * @brief Reads a setpoints file by mapping it, without copying it through stdio
+ * @version CENG153, serial: 85048a62
+ * @author Devansh Patel
+ * @since 2026-10-19
+ * @param fname setpoints file name
+ * @param spts setpoints read
+ * @return int 1 if spts is valid, 0 if the file does not exist or holds no setpoints, -1 if it is damaged
+ */
+int GhReadSetpoints(const char * fname, setpoint_s * spts)
+{
+    struct stat st;
+    void * map;
+    int fd, rv;
+
+    fd = open(fname, O_RDONLY);
+    if(fd < 0)
+    {
+        return 0;
+    }
+    if(fstat(fd, &st) != 0 || st.st_size == 0 || st.st_size > SETMAXSZ)
+    {
+        close(fd);
+        return -1;
+    }
+    // The file is only ever replaced by a rename, so the mapped inode never changes underneath
+    map = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if(map == MAP_FAILED)
+    {
+        return -1;
+    }
+    rv = GhDecodeSetpoints(map, st.st_size, spts);
+    munmap(map, st.st_size);
+    return rv;
+}
+
 /**
  * @brief saves setpoints
  * @version CENG153, serial: 85048a62
@@ -276,17 +443,30 @@ reading_s GhGetReadings(void)
 
 int GhSaveSetpoints(char * fname,setpoint_s spts)
 {
-    FILE *fp;
+    uint8_t rec[SETRECSZ];
+    char tmp[SETNAMESZ];
+    size_t len;
+    int fd, ok;
 
-    fp = fopen(fname,"w");
-    if(fp == NULL)
+    if(snprintf(tmp, sizeof(tmp), "%s.tmp", fname) >= (int) sizeof(tmp))
+    {
+        return 0;
+    }
+    fd = open(tmp, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if(fd < 0)
     {
         return 0;
     }
 
-    fwrite(&spts, sizeof(spts), 1, fp);
-
-    fclose(fp);
+    // Readers see either the old file or the new one, never a partial write
+    len = GhEncodeSetpoints(rec, spts);
+    ok = write(fd, rec, len) == (ssize_t) len && fsync(fd) == 0;
+    ok = close(fd) == 0 && ok;
+    if(!ok || rename(tmp, fname) != 0)
+    {
+        unlink(tmp);
+        return 0;
+    }
     return 1;
 }
 
@@ -302,17 +482,11 @@ int GhSaveSetpoints(char * fname,setpoint_s spts)
 setpoint_s GhRetrieveSetpoints(char * fname)
 {
     setpoint_s spts = {0};
-    FILE *fp;
 
-    fp = fopen(fname,"r");
-    if(fp == NULL)
+    if(GhReadSetpoints(fname, &spts) != 1)
     {
-        return spts;
+        memset(&spts, 0, sizeof(spts));
     }
-
-    fread(&spts, sizeof(spts), 1, fp);
-    fclose(fp);
-
     return spts;
 }
 
@@ -328,26 +502,40 @@ setpoint_s GhRetrieveSetpoints(char * fname)
    @param value presenting height
  * @return EXIT_SUCCESS if it successful otherwise EXIT_FAILURE
  */
-int GhSetVerticalBar(int bar, COLOR_SENSEHAT pxc,uint8_t value, struct fb_t *fb)
+int GhSetVerticalBar(int bar, COLOR_SENSEHAT pxc,int value, struct fb_t *fb)
 {
 	int i;
 
 	if (value > 7){
 		value = 7;
 	}
-	if (bar <0 || bar>= 8 || value <0 || value >7) {
+	if (bar <0 || bar>= 8 || value < -1) {
 		return EXIT_FAILURE;
 	}
 	for ( i = 0; i<= value;i++) {
 		ShLightPixel (i, bar, pxc , fb);
 	}
 	for ( i = value +1 ; i< 8; i++) {
-		ShLightPixel (bar, 1 , BLACK , fb);
+		ShLightPixel (i, bar, BLACK , fb);
 	}
 
 	return EXIT_SUCCESS;
 }
 
+/**
+ * @brief Maps a value to a bar height with the precomputed display map
+ * @param map display map of the configuration snapshot
+ * @param ch channel, 0 temperature, 1 humidity, 2 pressure
+ * @param v value
+ * @return int bar height, -1 for an empty bar up to 7 for a full one
+ */
+static int GhDisplayLevel(const dispmap_s * map, int ch, float v)
+{
+	int level = (int)(v * map->mul[ch] + map->off[ch]) - 1;
+
+	return (level > 7) ? 7 : (level < -1) ? -1 : level;
+}
+
 /**
  * @brief Displays data on LED matrix
  * @version CENG153, serial: 85048a62
@@ -361,29 +549,18 @@ int GhSetVerticalBar(int bar, COLOR_SENSEHAT pxc,uint8_t value, struct fb_t *fb)
  */
 
 void GhDisplayAll (reading_s rd, setpoint_s sd, struct fb_t *fb) {
-	int rv, sv, avh , avl;
-	COLOR_SENSEHAT pxc;
+	const dispmap_s * map = &GhConfigGet()->map;
+	int sv;
 
 	ShWipeScreen(BLACK,fb);
-    rv = (int)(8.0 * (((rd.temperature-LSTEMP) / (USTEMP-LSTEMP))+0.05))-1.0;
-	pxc = GREEN;
-	GhSetVerticalBar(TBAR, pxc ,rv, fb);
-
-	sv = (int)(8.0 * (((rd.humidity-LSHUMID) / (USHUMID-LSHUMID))+0.05))-1.0;
-	pxc = GREEN;
-	GhSetVerticalBar(HBAR, pxc ,sv, fb);
-
-	avh = (int)(8.0 * (((rd.pressure-LSPRESS) / (USPRESS-LSPRESS))+0.05))-1.0;
-	pxc = GREEN;
-	GhSetVerticalBar(PBAR, pxc ,avh, fb);
-
-	sv = (int)(8.0 * (((sd.temperature-LSTEMP) / (USTEMP-LSTEMP))+0.05))-1.0;
-	pxc = MAGENTA;
-	ShLightPixel(sv,TBAR, pxc, fb);
-
-	sv = (int)(8.0 * (((sd.humidity-LSHUMID) / (USHUMID-LSHUMID))+0.05))-1.0;
-	pxc = MAGENTA;
-	ShLightPixel(sv, HBAR , pxc, fb);
+	GhSetVerticalBar(TBAR, GREEN, GhDisplayLevel(map, 0, rd.temperature), fb);
+	GhSetVerticalBar(HBAR, GREEN, GhDisplayLevel(map, 1, rd.humidity), fb);
+	GhSetVerticalBar(PBAR, GREEN, GhDisplayLevel(map, 2, rd.pressure), fb);
+
+	sv = GhDisplayLevel(map, 0, sd.temperature);
+	ShLightPixel((sv < 0) ? 0 : sv, TBAR, MAGENTA, fb);
+	sv = GhDisplayLevel(map, 1, sd.humidity);
+	ShLightPixel((sv < 0) ? 0 : sv, HBAR, MAGENTA, fb);
 }
 
 /**
@@ -397,14 +574,7 @@ void GhDisplayAll (reading_s rd, setpoint_s sd, struct fb_t *fb) {
 
 alarmlimit_s GhSetAlarmLimits()
 {
-    alarmlimit_s calarm = {0};
-    calarm.hight = UPPERATEMP;
-    calarm.highh = UPPERAHUMID;
-    calarm.highp = UPPERAPRESS;
-    calarm.lowt = LOWERATEMP;
-    calarm.lowh = LOWERAHUMID;
-    calarm.lowp = LOWERAPRESS;
-    return calarm;
+    return GhConfigGet()->alimits;
 }
 
 /**
@@ -451,97 +621,6 @@ void GhDisplayAlarms(alarm_s * head)
     }
 }
 
-/**
- * @brief Sets one alarm
- * @version CENG153, serial: 85048a62
- * @author Paul Moggach
- * @author Devansh Patel
- * @since 2024-04-13
- * @param alarm_e code Alarm code to set
- * @param time_t atime Alarm time
- * @param double value Alarm value
- * @param alarm_s head Pointer to the head of the alarm list
- * @return int Returns 1 if alarm set successfully, 0 otherwise
- */
-
-int GhSetOneAlarm(alarm_e code,time_t atime,double value,alarm_s * head)
-{
-    alarm_s *cur = head;
-    alarm_s *last = NULL;
-
-    if(cur->code == NOALARM)
-    {
-        cur->code = code;
-        cur->atime = atime;
-        cur->value = value;
-        cur->next = NULL;
-        return 1;
-    }
-
-    while(cur != NULL)
-    {
-        if(cur->code == code)
-        {
-            return 0;
-        }
-
-        last = cur;
-        cur=cur->next;
-    }
-    cur = (alarm_s *) calloc(1,sizeof(alarm_s));
-    last->next = cur;
-
-    cur->code = code;
-    cur->atime = atime;
-    cur->value = value;
-    cur->next = NULL;
-    return 1;
-}
-
-/**
- * @brief Clears one alarm
- * @version CENG153, serial: 85048a62
- * @author Paul Moggach
- * @author Devansh Patel
- * @since 2024-04-13
- * @param alarm_e code Alarm code to clear
- * @param alarm_s head Pointer to the head of the alarm list
- * @return alarm_s* Returns the updated head of the alarm list
- */
-
-alarm_s * GhClearOneAlarm(alarm_e code,alarm_s * head)
-{
-    alarm_s *cur = head;
-    alarm_s *last = head;
-
-    if(cur->code == code && cur->next == NULL)
-    {
-        cur->code = NOALARM;
-        return head;
-    }
-
-    if(cur->code == code && cur->next != NULL)
-    {
-        head = cur->next;
-        free(cur);
-        return head;
-    }
-
-    while(cur != NULL)
-    {
-        if(cur->code == code)
-        {
-            last->next = cur->next;
-            free(cur);
-            return head;
-        }
-        last = cur;
-        cur = cur->next;
-    }
-
-    return head;
-}
-
 /**
  * @brief Sets alarms based on given alarm limits and reading data
  * @version CENG153, serial: 85048a62
@@ -556,68 +635,18 @@ alarm_s * GhClearOneAlarm(alarm_e code,alarm_s * head)
 
 alarm_s * GhSetAlarms(alarm_s * head,alarmlimit_s alarmpt, reading_s rdata)
 {
-    alarm_s *cur = head;
-    while(cur != NULL)
-    {
-        cur->code = NOALARM;
-        cur = cur->next;
-    }
-
-    if(rdata.temperature >= alarmpt.hight)
-    {
-        GhSetOneAlarm(HTEMP, rdata.rtime, rdata.temperature, head);
-    }
-    else
-    {
-        head = GhClearOneAlarm(HTEMP, head);
-    }
-
-    if(rdata.temperature <= alarmpt.lowt)
-    {
-        GhSetOneAlarm(LTEMP, rdata.rtime, rdata.temperature, head);
-    }
-    else
-    {
-        head = GhClearOneAlarm(LTEMP, head);
-    }
-
-    if(rdata.humidity >= alarmpt.highh)
-    {
-        GhSetOneAlarm(HHUMID, rdata.rtime, rdata.humidity, head);
-    }
-    else
-    {
-        head = GhClearOneAlarm(HHUMID, head);
-    }
-
-    if(rdata.humidity <= alarmpt.lowh)
-    {
-        GhSetOneAlarm(LHUMID, rdata.rtime, rdata.humidity, head);
-    }
-    else
-    {
-        head = GhClearOneAlarm(LHUMID, head);
-    }
+    // The list is now a view of a fixed table, head is kept for the old signature only
+    static alarmtable_s alarms;
+    static alarmrules_s rules;
+    float ch[ALARMCHANNELS];
 
-    if(rdata.pressure >= alarmpt.highp)
+    (void) head;
+    if(rules.n < ALARMBASE || memcmp(&rules.limits, &alarmpt, sizeof(alarmlimit_s)) != 0)
     {
-        GhSetOneAlarm(HPRESS, rdata.rtime, rdata.pressure, head);
+        GhAlarmRulesDefault(&rules, alarmpt);
+        GhAlarmTableRules(&alarms, &rules, rdata.rtime);
     }
-    else
-    {
-        head = GhClearOneAlarm(HPRESS, head);
-    }
-
-    if(rdata.pressure <= alarmpt.lowp)
-    {
-        GhSetOneAlarm(LPRESS, rdata.rtime, rdata.pressure, head);
-    }
-    else
-    {
-        head = GhClearOneAlarm(LPRESS, head);
-    }
-
-    return head;
+    GhAlarmChannels(rdata, ch);
+    GhAlarmTableUpdate(&alarms, &rules, ch, rdata.rtime, alarmpt.debounce);
+    return GhAlarmList(&alarms);
 }
-
-
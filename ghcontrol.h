@@ -25,6 +25,9 @@
 #define SIMHUMIDITY 0
 #define SIMPRESSURE 0
 
+// The ring and the daily partitions hold the readings, 1 also appends them to ghdata.txt
+#define LOGTEXT 0
+
 #define USTEMP 50
 #define LSTEMP -10
 #define USHUMID 100
@@ -32,6 +35,14 @@
 #define USPRESS 1016
 #define LSPRESS 975
 
+#define SETPOINTFILE "setpoints.dat"
+#define SETMAGIC "GHSP"
+#define SETVERSION 1
+#define SETFIELDS 2
+#define SETHDRSZ 8
+#define SETRECSZ (SETHDRSZ + 4 * SETFIELDS + 4)
+#define SETMAXSZ 4096
+#define SETNAMESZ 256
 #define STEMP 25.0
 #define SHUMID 55.0
 #define ON 1
@@ -52,6 +63,10 @@
 #define LOWERATEMP 10
 #define LOWERAHUMID 25
 #define LOWERAPRESS 985
+#define HYSTATEMP 0.5
+#define HYSTAHUMID 2.0
+#define HYSTAPRESS 1.0
+#define ALARMDEBOUNCE 4
 #define ALARMNMSZ 18
 
 // Enumerated Types
@@ -86,6 +101,10 @@ typedef struct alarmlimits
     float lowh;
     float highp;
     float lowp;
+    float hystt;
+    float hysth;
+    float hystp;
+    float debounce;
 } alarmlimit_s;
 
 typedef struct alarms
@@ -93,7 +112,7 @@ typedef struct alarms
     alarm_e code;
     time_t atime;
     float value;
-    struct alarm *next;
+    struct alarms *next;
 } alarm_s;
 
 //
@@ -114,12 +133,13 @@ reading_s GhGetReadings(void);
 int GhLogData(char * fname, reading_s ghdata);
 int GhSaveSetpoints(char * fname, setpoint_s spts);
 setpoint_s GhRetrieveSetpoints(char * fname);
-int GhSetVerticalBar(int bar, COLOR_SENSEHAT pxc,uint8_t value, struct fb_t *fb);
+size_t GhEncodeSetpoints(uint8_t * buf, setpoint_s spts);
+int GhDecodeSetpoints(const uint8_t * buf, size_t len, setpoint_s * spts);
+int GhReadSetpoints(const char * fname, setpoint_s * spts);
+int GhSetVerticalBar(int bar, COLOR_SENSEHAT pxc,int value, struct fb_t *fb);
 void GhDisplayAll (reading_s rd, setpoint_s sd, struct fb_t *fb);
 alarmlimit_s GhSetAlarmLimits(void);
 alarm_s * GhSetAlarms(alarm_s * head,alarmlimit_s alarmpt, reading_s rdata);
 void GhDisplayAlarms(alarm_s * head);
-int GhSetOneAlarm(alarm_e code,time_t atime,double value,alarm_s * head);
-alarm_s * GhClearOneAlarm(alarm_e code,alarm_s * head);
 //@endcond
 #endif
@@ -0,0 +1,386 @@
+/** @brief Full-screen operator dashboard drawn with ncurses
+*   @file ghdash.c
+*   Replaces the block of text GhDisplayReadings, GhDisplayTargets,
+*   GhDisplayControls and GhDisplayAlarms print every cycle with a fixed
+*   screen: readings against setpoints and controls, a sparkline of the
+*   last DASHSPARK readings of each sensor, the active alarms, the most
+*   recent alarm events and the LED frame pacing.
+*
+*   The dashboard keeps what it last drew of every field and only formats
+*   and draws the fields whose value changed. ncurses in turn compares the
+*   screen with what the terminal already shows and sends only the cells
+*   that differ, so a cycle in which nothing changed writes nothing. The
+*   clock shows minutes for the same reason.
+*/
+
+#include "ghdash.h"
+#include "ghconfig.h"
+#include <curses.h>
+
+static const char sparkchars[DASHLEVELS + 1] = "_.:-=+*#";
+static const char * const sensornames[SENSORS] = {"Temperature", "Humidity", "Pressure"};
+
+/**
+ * @brief Draws the labels that never change
+ * @param db dashboard
+ * @return void
+ */
+static void GhDashLabels(const dash_s * db)
+{
+    int ch;
+
+    erase();
+    mvprintw(0, 0, "Greenhouse Controller  Unit %llX", (unsigned long long) db->serial);
+    mvaddstr(DASHREADROW - 1, DASHVALCOL, "Reading");
+    mvaddstr(DASHREADROW - 1, DASHSETCOL, "Setpoint");
+    mvaddstr(DASHREADROW - 1, DASHCTLCOL, "Control");
+    mvaddstr(DASHREADROW - 1, DASHSPARKCOL, "History, newest right");
+    for(ch = 0; ch < SENSORS; ch++)
+    {
+        mvaddstr(DASHREADROW + ch, 0, sensornames[ch]);
+    }
+    mvaddstr(DASHALARMROW - 1, 0, "Active alarms");
+    mvaddstr(DASHEVENTROW - 1, 0, "Recent alarm events");
+}
+
+/**
+ * @brief Redraws the clock when the minute changes
+ * @param db dashboard
+ * @param now reading time
+ * @return int 1 if drawn
+ */
+static int GhDashClock(dash_s * db, time_t now)
+{
+    char stamp[CTIMESTRSZ];
+    struct tm lt;
+
+    if(!db->full && now / 60 == db->minute)
+    {
+        return 0;
+    }
+    db->minute = now / 60;
+    localtime_r(&now, &lt);
+    strftime(stamp, sizeof(stamp), "%Y-%m-%d %H:%M", &lt);
+    mvaddstr(0, DASHSPARKCOL + DASHSPARK - (int) strlen(stamp), stamp);
+    return 1;
+}
+
+/**
+ * @brief Redraws readings, setpoints and controls that changed
+ * @param db dashboard
+ * @param rd reading
+ * @param sp setpoints
+ * @param ctl controls
+ * @return int number of fields drawn
+ */
+static int GhDashValues(dash_s * db, reading_s rd, setpoint_s sp, control_s ctl)
+{
+    int n = 0;
+
+    if(db->full || rd.temperature != db->rd.temperature)
+    {
+        mvprintw(DASHREADROW, DASHVALCOL, "%7.1f C", rd.temperature);
+        n++;
+    }
+    if(db->full || rd.humidity != db->rd.humidity)
+    {
+        mvprintw(DASHREADROW + 1, DASHVALCOL, "%7.1f %%", rd.humidity);
+        n++;
+    }
+    if(db->full || rd.pressure != db->rd.pressure)
+    {
+        mvprintw(DASHREADROW + 2, DASHVALCOL, "%7.1f mb", rd.pressure);
+        n++;
+    }
+    if(db->full || sp.temperature != db->sp.temperature)
+    {
+        mvprintw(DASHREADROW, DASHSETCOL, "%7.1f C", sp.temperature);
+        n++;
+    }
+    if(db->full || sp.humidity != db->sp.humidity)
+    {
+        mvprintw(DASHREADROW + 1, DASHSETCOL, "%7.1f %%", sp.humidity);
+        n++;
+    }
+    if(db->full || ctl.heater != db->ctl.heater)
+    {
+        mvprintw(DASHREADROW, DASHCTLCOL, "Heat %-3s", ctl.heater ? "ON" : "OFF");
+        n++;
+    }
+    if(db->full || ctl.humidifier != db->ctl.humidifier)
+    {
+        mvprintw(DASHREADROW + 1, DASHCTLCOL, "Mist %-3s", ctl.humidifier ? "ON" : "OFF");
+        n++;
+    }
+    db->rd = rd;
+    db->sp = sp;
+    db->ctl = ctl;
+    return n;
+}
+
+/**
+ * @brief Looks up the sparkline character of a value
+ * @param db dashboard, for the channel's display range
+ * @param ch channel, 0 temperature, 1 humidity, 2 pressure
+ * @param v value
+ * @return char
+ */
+static char GhDashLevel(const dash_s * db, int ch, float v)
+{
+    int level = db->scale[ch] * (v - db->low[ch]) * DASHLEVELS / NUMPTS;
+
+    return sparkchars[(level < 0) ? 0 : (level >= DASHLEVELS) ? DASHLEVELS - 1 : level];
+}
+
+/**
+ * @brief Adds a reading to the sparklines and redraws the ones that changed
+ * @param db dashboard
+ * @param rd reading
+ * @return int number of sparklines drawn
+ */
+static int GhDashSpark(dash_s * db, reading_s rd)
+{
+    const config_s * cfg = GhConfigGet();
+    float low[SENSORS] = {cfg->lstemp, cfg->lshumid, cfg->lspress};
+    float scale[SENSORS] = {cfg->tscale, cfg->hscale, cfg->pscale};
+    char line[DASHSPARK + 1];
+    int ch, col, i, rescale, n = 0;
+
+    db->hist[0][db->head] = rd.temperature;
+    db->hist[1][db->head] = rd.humidity;
+    db->hist[2][db->head] = rd.pressure;
+    db->count += db->count < DASHSPARK;
+    rescale = memcmp(low, db->low, sizeof(low)) != 0 || memcmp(scale, db->scale, sizeof(scale)) != 0;
+    memcpy(db->low, low, sizeof(low));
+    memcpy(db->scale, scale, sizeof(scale));
+
+    for(ch = 0; ch < SENSORS; ch++)
+    {
+        if(rescale)
+        {
+            // New display ranges rebuild the line from the history
+            memset(line, ' ', DASHSPARK);
+            for(col = DASHSPARK - db->count, i = (db->head + DASHSPARK - db->count + 1) % DASHSPARK; col < DASHSPARK; col++)
+            {
+                line[col] = GhDashLevel(db, ch, db->hist[ch][i]);
+                i = (i + 1) % DASHSPARK;
+            }
+        }
+        else
+        {
+            // Otherwise the line drawn last moves left one and takes the new sample
+            memcpy(line, db->spark[ch] + 1, DASHSPARK - 1);
+            line[DASHSPARK - 1] = GhDashLevel(db, ch, db->hist[ch][db->head]);
+        }
+        line[DASHSPARK] = '\0';
+        if(db->full || memcmp(line, db->spark[ch], DASHSPARK) != 0)
+        {
+            memcpy(db->spark[ch], line, sizeof(line));
+            mvaddstr(DASHREADROW + ch, DASHSPARKCOL, line);
+            n++;
+        }
+    }
+    db->head = (db->head + 1) % DASHSPARK;
+    return n;
+}
+
+/**
+ * @brief Redraws the active alarm pane when the set of active rules changes
+ * @param db dashboard
+ * @param at alarm table after GhAlarmTableUpdate
+ * @return int 1 if drawn
+ */
+static int GhDashAlarms(dash_s * db, const alarmtable_s * at)
+{
+    char stamp[CTIMESTRSZ];
+    struct tm lt;
+    uint32_t bits;
+    int w, r, total = 0, shown, row = 0;
+
+    if(!db->full && memcmp(at->active, db->active, sizeof(db->active)) == 0)
+    {
+        return 0;
+    }
+    memcpy(db->active, at->active, sizeof(db->active));
+    for(w = 0; w < ALARMWORDS; w++)
+    {
+        total += __builtin_popcount(at->active[w]);
+    }
+    // When they don't all fit the last row counts the rest
+    shown = (total > DASHALARMROWS) ? DASHALARMROWS - 1 : total;
+    for(w = 0; w < ALARMWORDS && row < shown; w++)
+    {
+        for(bits = at->active[w]; bits != 0 && row < shown; bits &= bits - 1)
+        {
+            r = w * 32 + __builtin_ctz(bits);
+            localtime_r(&at->slot[r].atime, &lt);
+            strftime(stamp, sizeof(stamp), "%H:%M:%S", &lt);
+            move(DASHALARMROW + row++, 0);
+            clrtoeol();
+            printw("%-*s %8.1f  since %s  rule %d", ALARMNMSZ, alarmnames[at->slot[r].code], at->slot[r].value, stamp, r);
+        }
+    }
+    for(; row < DASHALARMROWS; row++)
+    {
+        move(DASHALARMROW + row, 0);
+        clrtoeol();
+    }
+    if(total == 0)
+    {
+        mvaddstr(DASHALARMROW, 0, "none");
+    }
+    else if(total > shown)
+    {
+        mvprintw(DASHALARMROW + shown, 0, "%d more", total - shown);
+    }
+    return 1;
+}
+
+/**
+ * @brief Adds the events of the last alarm update to the event pane and redraws it
+ * @param db dashboard
+ * @param at alarm table after GhAlarmTableUpdate
+ * @return int 1 if drawn
+ */
+static int GhDashEvents(dash_s * db, const alarmtable_s * at)
+{
+    char * line;
+    int i, len;
+
+    if(!db->full && at->nevents == 0)
+    {
+        return 0;
+    }
+    for(i = 0; i < at->nevents; i++)
+    {
+        line = db->events[db->ehead];
+        len = GhAlarmFormat(line, DASHLINESZ, &at->events[i]);
+        if(len > 0 && line[len - 1] == '\n')
+        {
+            line[len - 1] = '\0';
+        }
+        db->ehead = (db->ehead + 1) % DASHEVENTS;
+        db->ecount += db->ecount < DASHEVENTS;
+    }
+    // Oldest at the top, newest at the bottom
+    for(i = 0; i < DASHEVENTS; i++)
+    {
+        move(DASHEVENTROW + i, 0);
+        clrtoeol();
+        if(i < db->ecount)
+        {
+            addstr(db->events[(db->ehead + DASHEVENTS - db->ecount + i) % DASHEVENTS]);
+        }
+    }
+    return 1;
+}
+
+/**
+ * @brief Redraws the LED pacing line when frames were late or skipped
+ * @param db dashboard
+ * @param st animation frame statistics
+ * @return int 1 if drawn
+ */
+static int GhDashStats(dash_s * db, const animstats_s * st)
+{
+    if(!db->full && st->late == db->late && st->skipped == db->skipped)
+    {
+        return 0;
+    }
+    db->late = st->late;
+    db->skipped = st->skipped;
+    move(DASHSTATSROW, 0);
+    clrtoeol();
+    printw("LED panel %d fps, %lu frames late, %lu skipped, max lateness %.2f ms",
+           ANIMFPS, st->late, st->skipped, st->maxlate / 1e6);
+    return 1;
+}
+
+/**
+ * @brief Switches the terminal to the full-screen dashboard
+ * @version CENG153, serial: 85048a62
+ * @author Devansh Patel
+ * @since 2026-10-19
+ * @param db dashboard to initialise
+ * @return int 1 on success, 0 if the terminal cannot be used
+ */
+int GhDashOpen(dash_s * db)
+{
+    int ch;
+
+    memset(db, 0, sizeof(*db));
+    db->serial = ShGetSerial();
+    for(ch = 0; ch < SENSORS; ch++)
+    {
+        memset(db->spark[ch], ' ', DASHSPARK);
+    }
+    if(newterm(NULL, stdout, stdin) == NULL)
+    {
+        fprintf(stderr,"\nCannot start the dashboard on terminal %s\n", getenv("TERM") ? getenv("TERM") : "(unset)");
+        return 0;
+    }
+    cbreak();
+    noecho();
+    nodelay(stdscr, TRUE);
+    keypad(stdscr, TRUE);
+    curs_set(0);
+    db->full = 1;
+    return 1;
+}
+
+/**
+ * @brief Brings the dashboard up to date with one control cycle
+ * @version CENG153, serial: 85048a62
+ * @author Devansh Patel
+ * @since 2026-10-19
+ * @param db dashboard from GhDashOpen
+ * @param rd reading
+ * @param sp setpoints
+ * @param ctl controls
+ * @param at alarm table after GhAlarmTableUpdate
+ * @param st animation frame statistics
+ * @return void
+ */
+void GhDashUpdate(dash_s * db, reading_s rd, setpoint_s sp, control_s ctl, const alarmtable_s * at, const animstats_s * st)
+{
+    int key, n = 0;
+
+    // A resized terminal, or Ctrl-L, draws everything again from scratch
+    while((key = getch()) != ERR)
+    {
+        if(key == KEY_RESIZE || key == 'L' - '@')
+        {
+            clearok(curscr, TRUE);
+            db->full = 1;
+        }
+    }
+    if(db->full)
+    {
+        GhDashLabels(db);
+    }
+    n += GhDashClock(db, rd.rtime);
+    n += GhDashValues(db, rd, sp, ctl);
+    n += GhDashSpark(db, rd);
+    n += GhDashAlarms(db, at);
+    n += GhDashEvents(db, at);
+    n += GhDashStats(db, st);
+    db->full = 0;
+    if(n > 0)
+    {
+        refresh();
+    }
+}
+
+/**
+ * @brief Gives the terminal back
+ * @version CENG153, serial: 85048a62
+ * @author Devansh Patel
+ * @since 2026-10-19
+ * @param db dashboard from GhDashOpen
+ * @return void
+ */
+void GhDashClose(dash_s * db)
+{
+    (void) db;
+    endwin();
+}
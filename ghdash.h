@@ -0,0 +1,57 @@
+/** @brief Operator dashboard constants, structures, function prototypes
+*   @file ghdash.h
+*/
+
+#ifndef GHDASH_H
+#define GHDASH_H
+
+// Includes
+#include <stdint.h>
+#include "ghcontrol.h"
+#include "ghalarm.h"
+#include "ghanim.h"
+
+// Constants
+#define DASHSPARK 32
+#define DASHLEVELS 8
+#define DASHALARMROWS 6
+#define DASHEVENTS 6
+#define DASHLINESZ 80
+#define DASHVALCOL 13
+#define DASHSETCOL 25
+#define DASHCTLCOL 37
+#define DASHSPARKCOL 48
+#define DASHREADROW 3
+#define DASHALARMROW 8
+#define DASHEVENTROW (DASHALARMROW + DASHALARMROWS + 2)
+#define DASHSTATSROW (DASHEVENTROW + DASHEVENTS + 1)
+
+// Structures
+typedef struct dash
+{
+    int full;
+    uint64_t serial;
+    time_t minute;
+    reading_s rd;
+    setpoint_s sp;
+    control_s ctl;
+    float hist[SENSORS][DASHSPARK];
+    int head;
+    int count;
+    float low[SENSORS];
+    float scale[SENSORS];
+    char spark[SENSORS][DASHSPARK + 1];
+    uint32_t active[ALARMWORDS];
+    char events[DASHEVENTS][DASHLINESZ];
+    int ehead;
+    int ecount;
+    unsigned long late;
+    unsigned long skipped;
+} dash_s;
+
+//@cond INTERNAL
+int GhDashOpen(dash_s * db);
+void GhDashUpdate(dash_s * db, reading_s rd, setpoint_s sp, control_s ctl, const alarmtable_s * at, const animstats_s * st);
+void GhDashClose(dash_s * db);
+//@endcond
+#endif
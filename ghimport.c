@@ -0,0 +1,494 @@
+/** @brief Imports legacy ghdata.txt logs into the binary log format
+*   @file ghimport.c
+*   The text file is mmap'd, cut into one chunk per core at newline
+*   boundaries and parsed in parallel. Records are written in file order.
+*   With -z the records go to a compressed block archive instead.
+*   Run with -b to compare throughput against an fgets/sscanf baseline.
+*/
+
+#include "ghlog.h"
+#include "ghblock.h"
+#include <fcntl.h>
+#include <limits.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// Constants
+#define IMPMAXTHREADS 64
+#define IMPBENCHREPS 5
+#define IMPLINESZ 128
+#define IMPEST 40
+
+// Structures
+typedef struct impchunk
+{
+    const char * begin;
+    const char * end;
+    reading_s * recs;
+    size_t nrecs;
+    size_t cap;
+    size_t bad;
+} impchunk_s;
+
+/**
+ * @brief Seconds on the monotonic clock
+ * @return double seconds
+ */
+static double ImpNow(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/**
+ * @brief Thread body, parses every line of one chunk
+ * @param arg impchunk_s to parse
+ * @return NULL
+ */
+static void * ImpParseChunk(void * arg)
+{
+    impchunk_s * ck = arg;
+    tzcache_s tz = { INT64_MIN, 0 };
+    const char * p = ck->begin;
+    const char * nl;
+    reading_s * grown;
+
+    ck->nrecs = 0;
+    ck->bad = 0;
+    ck->cap = (ck->end - ck->begin) / IMPEST + 16;
+    ck->recs = malloc(ck->cap * sizeof(reading_s));
+    if(ck->recs == NULL)
+    {
+        ck->cap = 0;
+        return NULL;
+    }
+
+    while(p < ck->end)
+    {
+        nl = memchr(p, '\n', ck->end - p);
+        if(nl == NULL)
+        {
+            nl = ck->end;
+        }
+        if(ck->nrecs == ck->cap)
+        {
+            grown = realloc(ck->recs, ck->cap * 2 * sizeof(reading_s));
+            if(grown == NULL)
+            {
+                break;
+            }
+            ck->recs = grown;
+            ck->cap *= 2;
+        }
+        if(GhParseLogLine(p, nl, &ck->recs[ck->nrecs], &tz))
+        {
+            ck->nrecs++;
+        }
+        else if(nl - p > 1)
+        {
+            ck->bad++;
+        }
+        p = nl + 1;
+    }
+    return NULL;
+}
+
+/**
+ * @brief Splits a mapped file at newline boundaries and parses the pieces in parallel
+ * @param data mapped file
+ * @param size file size
+ * @param nthreads number of chunks and threads
+ * @param ck chunk array, nthreads entries
+ * @return int number of chunks actually used
+ */
+static int ImpParallelParse(const char * data, size_t size, int nthreads, impchunk_s * ck)
+{
+    pthread_t tid[IMPMAXTHREADS];
+    int started[IMPMAXTHREADS] = {0};
+    const char * p = data;
+    const char * end = data + size;
+    const char * cut;
+    int i, n = 0;
+
+    for(i = 0; i < nthreads && p < end; i++)
+    {
+        cut = (i == nthreads - 1) ? end : data + size / nthreads * (i + 1);
+        if(cut < p)
+        {
+            cut = p;
+        }
+        if(cut < end)
+        {
+            cut = memchr(cut, '\n', end - cut);
+            cut = (cut == NULL) ? end : cut + 1;
+        }
+        ck[n].begin = p;
+        ck[n].end = cut;
+        ck[n].recs = NULL;
+        p = cut;
+        n++;
+    }
+
+    for(i = 1; i < n; i++)
+    {
+        started[i] = pthread_create(&tid[i], NULL, ImpParseChunk, &ck[i]) == 0;
+        if(!started[i])
+        {
+            ImpParseChunk(&ck[i]);
+        }
+    }
+    ImpParseChunk(&ck[0]);
+    for(i = 1; i < n; i++)
+    {
+        if(started[i])
+        {
+            pthread_join(tid[i], NULL);
+        }
+    }
+    return n;
+}
+
+/**
+ * @brief Frees the record arrays of parsed chunks
+ * @param ck chunk array
+ * @param n number of chunks
+ * @return void
+ */
+static void ImpFreeChunks(impchunk_s * ck, int n)
+{
+    int i;
+
+    for(i = 0; i < n; i++)
+    {
+        free(ck[i].recs);
+        ck[i].recs = NULL;
+    }
+}
+
+/**
+ * @brief The fgets/sscanf/mktime parse this importer replaces
+ * @param fname text log
+ * @return size_t number of records parsed
+ */
+static size_t ImpScanfParse(const char * fname)
+{
+    static const char months[] = "JanFebMarAprMayJunJulAugSepOctNovDec";
+    char line[IMPLINESZ];
+    char mname[4];
+    const char * m;
+    struct tm tm;
+    reading_s rd;
+    size_t n = 0;
+    FILE * fp;
+
+    fp = fopen(fname,"r");
+    if(fp == NULL)
+    {
+        return 0;
+    }
+    while(fgets(line, sizeof(line), fp) != NULL)
+    {
+        memset(&tm, 0, sizeof(tm));
+        if(sscanf(line, "%*3s,%3s,%d,%d:%d:%d,%d,%f,%f,%f", mname, &tm.tm_mday, &tm.tm_hour, &tm.tm_min,
+                  &tm.tm_sec, &tm.tm_year, &rd.temperature, &rd.humidity, &rd.pressure) != 9)
+        {
+            continue;
+        }
+        m = strstr(months, mname);
+        if(m == NULL)
+        {
+            continue;
+        }
+        tm.tm_mon = (m - months) / 3;
+        tm.tm_year -= 1900;
+        tm.tm_isdst = -1;
+        rd.rtime = mktime(&tm);
+        n++;
+    }
+    fclose(fp);
+    return n;
+}
+
+/**
+ * @brief Finishes the encoder's block, appends it to a growing archive and starts the next
+ * @param enc encoder holding at least one reading
+ * @param arc archive buffer, grown with realloc
+ * @param cap capacity of arc
+ * @param used bytes used in arc
+ * @return int 1 on success, 0 if out of memory
+ */
+static int ImpArcPut(blockenc_s * enc, uint8_t ** arc, size_t * cap, size_t * used)
+{
+    size_t len = GhBlockFinish(enc);
+    uint8_t * grown;
+
+    if(*used + len > *cap)
+    {
+        grown = realloc(*arc, (*cap + len) * 2);
+        if(grown == NULL)
+        {
+            return 0;
+        }
+        *arc = grown;
+        *cap = (*cap + len) * 2;
+    }
+    memcpy(*arc + *used, enc->buf, len);
+    *used += len;
+    GhBlockBegin(enc);
+    return 1;
+}
+
+/**
+ * @brief Compresses parsed chunks into blocks, reports the size ratio and decode speed
+ * @param ck parsed chunks
+ * @param n number of chunks
+ * @param size size of the text log
+ * @param scanfsecs best time of the scanf baseline
+ * @return void
+ */
+static void ImpBenchArchive(impchunk_s * ck, int n, size_t size, double scanfsecs)
+{
+    blockenc_s * enc = malloc(sizeof(blockenc_s));
+    reading_s * out = malloc(BLOCKSAMPLES * sizeof(reading_s));
+    uint8_t * arc = NULL;
+    size_t cap = 0, used = 0, records = 0, off, j;
+    blockinfo_s info;
+    double t0, dt, best = 1e30;
+    int i, rep, full, ok = enc != NULL && out != NULL;
+
+    if(ok)
+    {
+        GhBlockBegin(enc);
+    }
+    for(i = 0; ok && i < n; i++)
+    {
+        for(j = 0; ok && j < ck[i].nrecs; j++)
+        {
+            full = GhBlockAdd(enc, &ck[i].recs[j]);
+            if(full < 0)
+            {
+                ok = ImpArcPut(enc, &arc, &cap, &used);
+                full = GhBlockAdd(enc, &ck[i].recs[j]);
+            }
+            if(full > 0)
+            {
+                ok = ok && ImpArcPut(enc, &arc, &cap, &used);
+            }
+        }
+    }
+    if(ok && enc->count > 0)
+    {
+        ok = ImpArcPut(enc, &arc, &cap, &used);
+    }
+
+    for(rep = 0; ok && rep < IMPBENCHREPS; rep++)
+    {
+        t0 = ImpNow();
+        for(off = 0, records = 0; off < used; off += info.size)
+        {
+            GhBlockInfo(arc + off, used - off, &info);
+            records += GhBlockDecode(arc + off, used - off, out, BLOCKSAMPLES);
+        }
+        dt = ImpNow() - t0;
+        if(dt < best)
+        {
+            best = dt;
+        }
+    }
+
+    if(ok && used > 0)
+    {
+        fprintf(stdout, " archive\t%9zu bytes\t%8.1fx smaller than text\n", used, (double) size / used);
+        fprintf(stdout, " block decode\t%9zu records\t%8.1f MB/s\t%5.1fx\n", records, size / 1e6 / best, scanfsecs / best);
+    }
+    free(arc);
+    free(out);
+    free(enc);
+}
+
+/**
+ * @brief Times the scanf baseline against the hand parser on 1 and nthreads cores
+ * @param fname text log
+ * @param data mapped file
+ * @param size file size
+ * @param nthreads number of threads for the parallel run
+ * @return int EXIT_SUCCESS
+ */
+static int ImpBenchmark(const char * fname, const char * data, size_t size, int nthreads)
+{
+    impchunk_s ck[IMPMAXTHREADS];
+    double mb = size / 1e6;
+    double t0, dt, best[3] = { 1e30, 1e30, 1e30 };
+    size_t count[3] = {0};
+    int rep, i, n;
+
+    for(rep = 0; rep < IMPBENCHREPS; rep++)
+    {
+        t0 = ImpNow();
+        count[0] = ImpScanfParse(fname);
+        dt = ImpNow() - t0;
+        if(dt < best[0])
+        {
+            best[0] = dt;
+        }
+
+        t0 = ImpNow();
+        n = ImpParallelParse(data, size, 1, ck);
+        dt = ImpNow() - t0;
+        if(dt < best[1])
+        {
+            best[1] = dt;
+        }
+        for(count[1] = 0, i = 0; i < n; i++)
+        {
+            count[1] += ck[i].nrecs;
+        }
+        ImpFreeChunks(ck, n);
+
+        t0 = ImpNow();
+        n = ImpParallelParse(data, size, nthreads, ck);
+        dt = ImpNow() - t0;
+        if(dt < best[2])
+        {
+            best[2] = dt;
+        }
+        for(count[2] = 0, i = 0; i < n; i++)
+        {
+            count[2] += ck[i].nrecs;
+        }
+        if(rep < IMPBENCHREPS - 1)
+        {
+            ImpFreeChunks(ck, n);
+        }
+    }
+
+    fprintf(stdout, "%s: %.1f MB, best of %d runs\n", fname, mb, IMPBENCHREPS);
+    fprintf(stdout, " scanf baseline\t%9zu records\t%8.1f MB/s\n", count[0], mb / best[0]);
+    fprintf(stdout, " parser x1\t%9zu records\t%8.1f MB/s\t%5.1fx\n", count[1], mb / best[1], best[0] / best[1]);
+    fprintf(stdout, " parser x%d\t%9zu records\t%8.1f MB/s\t%5.1fx\n", nthreads, count[2], mb / best[2], best[0] / best[2]);
+    ImpBenchArchive(ck, n, size, best[0]);
+    ImpFreeChunks(ck, n);
+    return EXIT_SUCCESS;
+}
+
+/**
+ * @brief ghimport [-b] [-z] [-j threads] ghdata.txt [ghdata.bin | ghdata.ghz]
+ * @return EXIT_SUCCESS if every chunk was imported
+ */
+int main(int argc, char * argv[])
+{
+    impchunk_s ck[IMPMAXTHREADS];
+    binlog_s * bl = NULL;
+    blockenc_s * zl = NULL;
+    struct stat st;
+    size_t j;
+    size_t total = 0, bad = 0;
+    int bench = 0, archive = 0, nthreads, opt, fd, n, i, ok = 1;
+    char * data;
+
+    nthreads = sysconf(_SC_NPROCESSORS_ONLN);
+    while((opt = getopt(argc, argv, "bzj:")) != -1)
+    {
+        switch(opt)
+        {
+            case 'b':
+                bench = 1;
+                break;
+            case 'z':
+                archive = 1;
+                break;
+            case 'j':
+                nthreads = atoi(optarg);
+                break;
+            default:
+                optind = argc;
+                break;
+        }
+    }
+    if(nthreads < 1)
+    {
+        nthreads = 1;
+    }
+    if(nthreads > IMPMAXTHREADS)
+    {
+        nthreads = IMPMAXTHREADS;
+    }
+    if(argc - optind != (bench ? 1 : 2))
+    {
+        fprintf(stderr, "usage: %s [-j threads] ghdata.txt ghdata.bin\n       %s -z [-j threads] ghdata.txt ghdata.ghz\n       %s -b [-j threads] ghdata.txt\n", argv[0], argv[0], argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    fd = open(argv[optind], O_RDONLY);
+    if(fd < 0 || fstat(fd, &st) < 0)
+    {
+        fprintf(stderr, "\nCan't open %s\n", argv[optind]);
+        return EXIT_FAILURE;
+    }
+    if(st.st_size == 0)
+    {
+        fprintf(stderr, "\n%s is empty\n", argv[optind]);
+        return EXIT_FAILURE;
+    }
+    data = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if(data == MAP_FAILED)
+    {
+        fprintf(stderr, "\nFailed to mmap %s\n", argv[optind]);
+        return EXIT_FAILURE;
+    }
+    madvise(data, st.st_size, MADV_SEQUENTIAL);
+
+    if(bench)
+    {
+        return ImpBenchmark(argv[optind], data, st.st_size, nthreads);
+    }
+
+    if(archive)
+    {
+        zl = malloc(sizeof(blockenc_s));
+        if(zl == NULL || !GhBlockEncOpen(zl, argv[optind + 1]))
+        {
+            return EXIT_FAILURE;
+        }
+    }
+    else
+    {
+        bl = malloc(sizeof(binlog_s));
+        if(bl == NULL || !GhBinLogOpen(bl, argv[optind + 1], LOGBATCHMAX))
+        {
+            return EXIT_FAILURE;
+        }
+    }
+    n = ImpParallelParse(data, st.st_size, nthreads, ck);
+    for(i = 0; i < n; i++)
+    {
+        if(ck[i].recs == NULL)
+        {
+            ok = 0;
+            continue;
+        }
+        if(zl != NULL)
+        {
+            for(j = 0; j < ck[i].nrecs; j++)
+            {
+                ok &= GhBlockEncAppend(zl, &ck[i].recs[j]);
+            }
+        }
+        else
+        {
+            ok &= GhBinLogAppend(bl, ck[i].recs, ck[i].nrecs);
+        }
+        total += ck[i].nrecs;
+        bad += ck[i].bad;
+    }
+    ok &= (zl != NULL) ? GhBlockEncClose(zl) : GhBinLogClose(bl);
+    ImpFreeChunks(ck, n);
+
+    fprintf(stdout, "Imported %zu records from %s (%zu malformed lines skipped)\n", total, argv[optind], bad);
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,614 @@
+/** @brief Binary log format and legacy ghdata.txt parsing
+*   @file ghlog.c
+*   After the header the log is a sequence of commit batches: u32 payload
+*   length, u32 CRC32C of the length and payload, then the records. A
+*   batch is written with one write() and made durable with one
+*   fdatasync(), so a power cut loses at most the open batch and the
+*   recovery scan in GhBinLogOpen truncates any torn tail.
+*/
+
+#include "ghlog.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <pthread.h>
+#include <unistd.h>
+
+static uint32_t crc32ctable[256];
+
+/**
+ * @brief Stores a 32 bit value little-endian
+ * @version CENG153, serial: 85048a62
+ * @author Devansh Patel
+ * @since 2026-10-19
+ * @param p destination, at least 4 bytes
+ * @param v value to store
+ * @return void
+ */
+void GhPutLe32(uint8_t * p, uint32_t v)
+{
+    p[0] = v;
+    p[1] = v >> 8;
+    p[2] = v >> 16;
+    p[3] = v >> 24;
+}
+
+/**
+ * @brief Stores a 64 bit value little-endian
+ * @version CENG153, serial: 85048a62
+ * @author Devansh Patel
+ * @since 2026-10-19
+ * @param p destination, at least 8 bytes
+ * @param v value to store
+ * @return void
+ */
+void GhPutLe64(uint8_t * p, uint64_t v)
+{
+    GhPutLe32(p, (uint32_t) v);
+    GhPutLe32(p + 4, (uint32_t) (v >> 32));
+}
+
+/**
+ * @brief Loads a little-endian 32 bit value
+ * @version CENG153, serial: 85048a62
+ * @author Devansh Patel
+ * @since 2026-10-19
+ * @param p source, at least 4 bytes
+ * @return uint32_t the value
+ */
+uint32_t GhGetLe32(const uint8_t * p)
+{
+    return (uint32_t) p[0] | (uint32_t) p[1] << 8 | (uint32_t) p[2] << 16 | (uint32_t) p[3] << 24;
+}
+
+/**
+ * @brief Loads a little-endian 64 bit value
+ * @version CENG153, serial: 85048a62
+ * @author Devansh Patel
+ * @since 2026-10-19
+ * @param p source, at least 8 bytes
+ * @return uint64_t the value
+ */
+uint64_t GhGetLe64(const uint8_t * p)
+{
+    return (uint64_t) GhGetLe32(p) | (uint64_t) GhGetLe32(p + 4) << 32;
+}
+
+/**
+ * @brief Serializes one reading into a LOGRECSZ byte record
+ * @version CENG153, serial: 85048a62
+ * @author Devansh Patel
+ * @since 2026-10-19
+ * @param p destination, LOGRECSZ bytes
+ * @param rd reading to store
+ * @return void
+ */
+void GhPackRecord(uint8_t * p, const reading_s * rd)
+{
+    uint32_t f;
+
+    GhPutLe64(p, (uint64_t) (int64_t) rd->rtime);
+    memcpy(&f, &rd->temperature, 4);
+    GhPutLe32(p + 8, f);
+    memcpy(&f, &rd->humidity, 4);
+    GhPutLe32(p + 12, f);
+    memcpy(&f, &rd->pressure, 4);
+    GhPutLe32(p + 16, f);
+}
+
+/**
+ * @brief Deserializes one LOGRECSZ byte record
+ * @version CENG153, serial: 85048a62
+ * @author Devansh Patel
+ * @since 2026-10-19
+ * @param p source, LOGRECSZ bytes
+ * @param rd reading to fill in
+ * @return void
+ */
+void GhUnpackRecord(const uint8_t * p, reading_s * rd)
+{
+    uint32_t f;
+
+    rd->rtime = (time_t) (int64_t) GhGetLe64(p);
+    f = GhGetLe32(p + 8);
+    memcpy(&rd->temperature, &f, 4);
+    f = GhGetLe32(p + 12);
+    memcpy(&rd->humidity, &f, 4);
+    f = GhGetLe32(p + 16);
+    memcpy(&rd->pressure, &f, 4);
+}
+
+/**
+ * @brief Writes a whole buffer, retrying short writes
+ * @param fd file descriptor
+ * @param buf data
+ * @param len number of bytes
+ * @return 1 on success, 0 on error
+ */
+static int GhWriteAll(int fd, const uint8_t * buf, size_t len)
+{
+    ssize_t n;
+
+    while(len > 0)
+    {
+        n = write(fd, buf, len);
+        if(n < 0)
+        {
+            if(errno == EINTR)
+            {
+                continue;
+            }
+            return 0;
+        }
+        buf += n;
+        len -= n;
+    }
+    return 1;
+}
+
+/**
+ * @brief Fills the CRC32C (Castagnoli) lookup table
+ * @return void
+ */
+static void GhCrc32cInit(void)
+{
+    uint32_t c;
+    int i, k;
+
+    for(i = 0; i < 256; i++)
+    {
+        c = i;
+        for(k = 0; k < 8; k++)
+        {
+            c = (c >> 1) ^ (0x82F63B78 & -(c & 1));
+        }
+        crc32ctable[i] = c;
+    }
+}
+
+/**
+ * @brief Computes or continues a CRC32C
+ * @version CENG153, serial: 85048a62
+ * @author Devansh Patel
+ * @since 2026-10-19
+ * @param crc 0 to start, or the result of a previous call to continue
+ * @param buf data
+ * @param len number of bytes
+ * @return uint32_t the CRC
+ */
+uint32_t GhCrc32c(uint32_t crc, const void * buf, size_t len)
+{
+    static pthread_once_t once = PTHREAD_ONCE_INIT;
+    const uint8_t * p = buf;
+
+    pthread_once(&once, GhCrc32cInit);
+    crc = ~crc;
+    while(len-- > 0)
+    {
+        crc = crc32ctable[(crc ^ *p++) & 0xFF] ^ (crc >> 8);
+    }
+    return ~crc;
+}
+
+/**
+ * @brief Checks the commit batch at an offset
+ * @param fd binary log
+ * @param off offset of the batch header
+ * @param buf scratch space for the whole batch, LOGBUFSZ bytes
+ * @return size_t number of records in a valid batch, 0 if the batch is torn or damaged
+ */
+static size_t GhBatchCheck(int fd, off_t off, uint8_t * buf)
+{
+    uint32_t len;
+
+    if(pread(fd, buf, LOGFRAMESZ, off) != LOGFRAMESZ)
+    {
+        return 0;
+    }
+    len = GhGetLe32(buf);
+    if(len == 0 || len % LOGRECSZ != 0 || len > LOGBATCHMAX * LOGRECSZ ||
+       pread(fd, buf + LOGFRAMESZ, len, off + LOGFRAMESZ) != (ssize_t) len ||
+       GhCrc32c(GhCrc32c(0, buf, 4), buf + LOGFRAMESZ, len) != GhGetLe32(buf + 4))
+    {
+        return 0;
+    }
+    return len / LOGRECSZ;
+}
+
+/**
+ * @brief Opens a binary log for appending, recovering it to the last valid commit batch
+ * @version CENG153, serial: 85048a62
+ * @author Devansh Patel
+ * @since 2026-10-19
+ * @param bl log state to initialise
+ * @param fname file name of the binary log
+ * @param batch number of records per commit batch, at most LOGBATCHMAX
+ * @return int 1 if the log is ready, 0 if it cannot be opened or is not a binary log
+ */
+int GhBinLogOpen(binlog_s * bl, const char * fname, size_t batch)
+{
+    uint8_t hdr[LOGHDRSZ] = {0};
+    off_t size;
+    size_t n;
+
+    bl->used = 0;
+    bl->records = 0;
+    bl->batch = (batch < 1) ? 1 : (batch > LOGBATCHMAX) ? LOGBATCHMAX : batch;
+    bl->fd = open(fname, O_RDWR | O_CREAT, 0644);
+    if(bl->fd < 0)
+    {
+        fprintf(stderr,"\nCan't open binary log %s\n", fname);
+        return 0;
+    }
+
+    size = lseek(bl->fd, 0, SEEK_END);
+    if(size == 0)
+    {
+        memcpy(hdr, LOGMAGIC, 4);
+        hdr[4] = LOGVERSION;
+        hdr[6] = LOGRECSZ;
+        bl->end = LOGHDRSZ;
+        if(GhWriteAll(bl->fd, hdr, sizeof(hdr)) && fdatasync(bl->fd) == 0)
+        {
+            return 1;
+        }
+        // A torn header would fail the magic check on every later open
+        fprintf(stderr,"\nCan't write the header of binary log %s\n", fname);
+        if(ftruncate(bl->fd, 0) != 0)
+        {
+            fprintf(stderr,"\nCan't truncate binary log %s\n", fname);
+        }
+        close(bl->fd);
+        bl->fd = -1;
+        return 0;
+    }
+
+    if(pread(bl->fd, hdr, sizeof(hdr), 0) != sizeof(hdr) || memcmp(hdr, LOGMAGIC, 4) != 0 || hdr[4] != LOGVERSION)
+    {
+        fprintf(stderr,"\n%s is not a version %d binary log\n", fname, LOGVERSION);
+        close(bl->fd);
+        bl->fd = -1;
+        return 0;
+    }
+
+    // Recovery scan, everything after the last batch with a good CRC is a torn write
+    bl->end = LOGHDRSZ;
+    while((n = GhBatchCheck(bl->fd, bl->end, bl->buf)) > 0)
+    {
+        bl->end += LOGFRAMESZ + n * LOGRECSZ;
+        bl->records += n;
+    }
+    if(bl->end < size)
+    {
+        fprintf(stderr,"\nBinary log %s: discarding %ld bytes after the last valid batch\n", fname, (long) (size - bl->end));
+        if(ftruncate(bl->fd, bl->end) != 0 || fdatasync(bl->fd) != 0)
+        {
+            close(bl->fd);
+            bl->fd = -1;
+            return 0;
+        }
+    }
+    return 1;
+}
+
+/**
+ * @brief Adds readings to the open commit batch, committing each batch as it fills
+ * @version CENG153, serial: 85048a62
+ * @author Devansh Patel
+ * @since 2026-10-19
+ * @param bl open log
+ * @param recs readings to append
+ * @param n number of readings
+ * @return int 1 on success, 0 on a write error
+ */
+int GhBinLogAppend(binlog_s * bl, const reading_s * recs, size_t n)
+{
+    size_t i;
+
+    for(i = 0; i < n; i++)
+    {
+        GhPackRecord(bl->buf + LOGFRAMESZ + bl->used, &recs[i]);
+        bl->used += LOGRECSZ;
+        if(bl->used >= bl->batch * LOGRECSZ && !GhBinLogFlush(bl))
+        {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+/**
+ * @brief Commits the open batch: one framed write with length and CRC32C, then fdatasync
+ * @version CENG153, serial: 85048a62
+ * @author Devansh Patel
+ * @since 2026-10-19
+ * @param bl open log
+ * @return int 1 on success, 0 on a write error
+ */
+int GhBinLogFlush(binlog_s * bl)
+{
+    size_t len = bl->used;
+
+    if(len == 0)
+    {
+        return 1;
+    }
+    GhPutLe32(bl->buf, len);
+    GhPutLe32(bl->buf + 4, GhCrc32c(GhCrc32c(0, bl->buf, 4), bl->buf + LOGFRAMESZ, len));
+    bl->used = 0;
+    if(lseek(bl->fd, bl->end, SEEK_SET) < 0 || !GhWriteAll(bl->fd, bl->buf, LOGFRAMESZ + len) || fdatasync(bl->fd) != 0)
+    {
+        // Drop the torn batch now rather than leave it for the next recovery scan
+        fprintf(stderr,"\nBinary log write failed\n");
+        if(ftruncate(bl->fd, bl->end) != 0)
+        {
+            fprintf(stderr,"\nBinary log could not be truncated\n");
+        }
+        return 0;
+    }
+    bl->end += LOGFRAMESZ + len;
+    bl->records += len / LOGRECSZ;
+    return 1;
+}
+
+/**
+ * @brief Commits the open batch and closes a binary log
+ * @version CENG153, serial: 85048a62
+ * @author Devansh Patel
+ * @since 2026-10-19
+ * @param bl open log
+ * @return int 1 on success, 0 if the batch could not be committed
+ */
+int GhBinLogClose(binlog_s * bl)
+{
+    int ok = GhBinLogFlush(bl);
+
+    close(bl->fd);
+    bl->fd = -1;
+    return ok;
+}
+
+/**
+ * @brief Reads the readings in [from, to) from a binary log
+ * @version CENG153, serial: 85048a62
+ * @author Devansh Patel
+ * @since 2026-10-19
+ * @param fname file name of the binary log
+ * @param start offset of the first commit batch to read, 0 for the start of the log
+ * @param from earliest time
+ * @param to end of the range
+ * @param out readings read, in log order
+ * @param max capacity of out
+ * @return long number of readings, -1 if the log cannot be read
+ */
+long GhBinLogRead(const char * fname, off_t start, time_t from, time_t to, reading_s * out, long max)
+{
+    uint8_t hdr[LOGHDRSZ];
+    uint8_t * buf;
+    reading_s rd;
+    size_t n, i;
+    long count = 0;
+    int fd;
+
+    fd = open(fname, O_RDONLY);
+    if(fd < 0)
+    {
+        return -1;
+    }
+    buf = malloc(LOGBUFSZ);
+    if(buf == NULL || pread(fd, hdr, sizeof(hdr), 0) != sizeof(hdr) || memcmp(hdr, LOGMAGIC, 4) != 0 || hdr[4] != LOGVERSION)
+    {
+        free(buf);
+        close(fd);
+        return -1;
+    }
+
+    for(start = (start < LOGHDRSZ) ? LOGHDRSZ : start; count < max; start += LOGFRAMESZ + n * LOGRECSZ)
+    {
+        n = GhBatchCheck(fd, start, buf);
+        if(n == 0)
+        {
+            break;
+        }
+        for(i = 0; i < n && count < max; i++)
+        {
+            // A backward clock step can put readings in range after later ones, so the whole log is scanned
+            GhUnpackRecord(buf + LOGFRAMESZ + i * LOGRECSZ, &rd);
+            if(rd.rtime >= from && rd.rtime < to)
+            {
+                out[count++] = rd;
+            }
+        }
+    }
+    free(buf);
+    close(fd);
+    return count;
+}
+
+/**
+ * @brief Days since 1970-01-01 of a proleptic Gregorian date
+ * @param y year
+ * @param m month 1 - 12
+ * @param d day of month
+ * @return day number
+ */
+static int64_t GhDaysFromCivil(int64_t y, int m, int d)
+{
+    int64_t era, yoe, doy, doe;
+
+    y -= m <= 2;
+    era = (y >= 0 ? y : y - 399) / 400;
+    yoe = y - era * 400;
+    doy = (153 * (m + (m > 2 ? -3 : 9)) + 2) / 5 + d - 1;
+    doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    return era * 146097 + doe - 719468;
+}
+
+/**
+ * @brief Month number of a three letter ctime() month name
+ * @param p first letter of the name
+ * @return month 1 - 12, 0 if not a month name
+ */
+static int GhMonthNumber(const char * p)
+{
+    switch(p[0] << 16 | p[1] << 8 | p[2])
+    {
+        case 'J' << 16 | 'a' << 8 | 'n': return 1;
+        case 'F' << 16 | 'e' << 8 | 'b': return 2;
+        case 'M' << 16 | 'a' << 8 | 'r': return 3;
+        case 'A' << 16 | 'p' << 8 | 'r': return 4;
+        case 'M' << 16 | 'a' << 8 | 'y': return 5;
+        case 'J' << 16 | 'u' << 8 | 'n': return 6;
+        case 'J' << 16 | 'u' << 8 | 'l': return 7;
+        case 'A' << 16 | 'u' << 8 | 'g': return 8;
+        case 'S' << 16 | 'e' << 8 | 'p': return 9;
+        case 'O' << 16 | 'c' << 8 | 't': return 10;
+        case 'N' << 16 | 'o' << 8 | 'v': return 11;
+        case 'D' << 16 | 'e' << 8 | 'c': return 12;
+    }
+    return 0;
+}
+
+/**
+ * @brief Parses a run of digits at a fixed position
+ * @param p first digit, may be a leading space
+ * @param n number of characters
+ * @param v parsed value
+ * @return 1 if all characters were digits (or leading spaces), 0 otherwise
+ */
+static int GhFixedDigits(const char * p, int n, int * v)
+{
+    int i;
+
+    *v = 0;
+    for(i = 0; i < n; i++)
+    {
+        if(p[i] == ' ' && *v == 0)
+        {
+            continue;
+        }
+        if((unsigned) (p[i] - '0') > 9)
+        {
+            return 0;
+        }
+        *v = *v * 10 + (p[i] - '0');
+    }
+    return 1;
+}
+
+/**
+ * @brief Parses a "%5.1lf" style field
+ * @param p first character of the field
+ * @param end end of the line
+ * @param v parsed value
+ * @return pointer past the field, NULL if the field is malformed
+ */
+static const char * GhParseField(const char * p, const char * end, float * v)
+{
+    static const float scale[] = {1.0f, 0.1f, 0.01f, 0.001f, 0.0001f, 0.00001f, 0.000001f};
+    int neg = 0, digits = 0, frac = 0;
+    int32_t whole = 0, part = 0;
+
+    while(p < end && *p == ' ')
+    {
+        p++;
+    }
+    if(p < end && *p == '-')
+    {
+        neg = 1;
+        p++;
+    }
+    while(p < end && (unsigned) (*p - '0') <= 9 && digits < 9)
+    {
+        whole = whole * 10 + (*p++ - '0');
+        digits++;
+    }
+    if(p < end && *p == '.')
+    {
+        p++;
+        while(p < end && (unsigned) (*p - '0') <= 9)
+        {
+            if(frac < 6)
+            {
+                part = part * 10 + (*p - '0');
+                frac++;
+            }
+            p++;
+        }
+    }
+    if(digits == 0 && frac == 0)
+    {
+        return NULL;
+    }
+    *v = whole + part * scale[frac];
+    if(neg)
+    {
+        *v = -*v;
+    }
+    return p;
+}
+
+/**
+ * @brief Parses one "Day,Mon,dd,hh:mm:ss,yyyy,T,H,P" line written by GhLogData
+ * @version CENG153, serial: 85048a62
+ * @author Devansh Patel
+ * @since 2026-10-19
+ * @param p first character of the line
+ * @param end end of the line, excluding the newline
+ * @param rd reading to fill in
+ * @param tz per-thread cache of the local time offset, hour set to INT64_MIN before first use
+ * @return int 1 if the line was parsed, 0 if it is blank or malformed
+ */
+int GhParseLogLine(const char * p, const char * end, reading_s * rd, tzcache_s * tz)
+{
+    int mon, mday, hh, mm, ss, year;
+    int64_t civil, hour;
+    struct tm tm;
+
+    if(end > p && end[-1] == '\r')
+    {
+        end--;
+    }
+    if(end - p < LOGCSVTIMESZ + 6 || p[3] != ',' || p[7] != ',' || p[10] != ',' || p[13] != ':' ||
+       p[16] != ':' || p[19] != ',' || p[LOGCSVTIMESZ] != ',')
+    {
+        return 0;
+    }
+    mon = GhMonthNumber(p + 4);
+    if(mon == 0 || !GhFixedDigits(p + 8, 2, &mday) || !GhFixedDigits(p + 11, 2, &hh) ||
+       !GhFixedDigits(p + 14, 2, &mm) || !GhFixedDigits(p + 17, 2, &ss) || !GhFixedDigits(p + 20, 4, &year))
+    {
+        return 0;
+    }
+
+    // Wall-clock seconds as if the line were UTC, then shift by the local offset of that hour
+    civil = GhDaysFromCivil(year, mon, mday) * 86400 + hh * 3600 + mm * 60 + ss;
+    hour = civil / 3600;
+    if(hour != tz->hour)
+    {
+        memset(&tm, 0, sizeof(tm));
+        tm.tm_year = year - 1900;
+        tm.tm_mon = mon - 1;
+        tm.tm_mday = mday;
+        tm.tm_hour = hh;
+        tm.tm_isdst = -1;
+        tz->offset = hour * 3600 - (int64_t) mktime(&tm);
+        tz->hour = hour;
+    }
+    rd->rtime = (time_t) (civil - tz->offset);
+
+    p += LOGCSVTIMESZ + 1;
+    if((p = GhParseField(p, end, &rd->temperature)) == NULL || p >= end || *p++ != ',')
+    {
+        return 0;
+    }
+    if((p = GhParseField(p, end, &rd->humidity)) == NULL || p >= end || *p++ != ',')
+    {
+        return 0;
+    }
+    if((p = GhParseField(p, end, &rd->pressure)) == NULL)
+    {
+        return 0;
+    }
+    return 1;
+}
@@ -0,0 +1,57 @@
+/** @brief Binary log constants, structures, function prototypes
+*   @file ghlog.h
+*/
+
+#ifndef GHLOG_H
+#define GHLOG_H
+
+// Includes
+#include <stdint.h>
+#include <stddef.h>
+#include <sys/types.h>
+#include "ghcontrol.h"
+
+// Constants
+#define LOGMAGIC "GHLB"
+#define LOGVERSION 2
+#define LOGHDRSZ 16
+#define LOGRECSZ 20
+#define LOGBUFSZ 65536
+#define LOGFRAMESZ 8
+#define LOGBATCH 30
+#define LOGBATCHMAX ((LOGBUFSZ - LOGFRAMESZ) / LOGRECSZ)
+#define LOGCSVTIMESZ 24
+
+// Structures
+typedef struct binlog
+{
+    int fd;
+    off_t end;
+    size_t used;
+    size_t batch;
+    uint64_t records;
+    uint8_t buf[LOGBUFSZ];
+} binlog_s;
+
+typedef struct tzcache
+{
+    int64_t hour;
+    int64_t offset;
+} tzcache_s;
+
+//@cond INTERNAL
+void GhPutLe32(uint8_t * p, uint32_t v);
+void GhPutLe64(uint8_t * p, uint64_t v);
+uint32_t GhGetLe32(const uint8_t * p);
+uint64_t GhGetLe64(const uint8_t * p);
+void GhPackRecord(uint8_t * p, const reading_s * rd);
+void GhUnpackRecord(const uint8_t * p, reading_s * rd);
+uint32_t GhCrc32c(uint32_t crc, const void * buf, size_t len);
+int GhBinLogOpen(binlog_s * bl, const char * fname, size_t batch);
+int GhBinLogAppend(binlog_s * bl, const reading_s * recs, size_t n);
+int GhBinLogFlush(binlog_s * bl);
+int GhBinLogClose(binlog_s * bl);
+long GhBinLogRead(const char * fname, off_t start, time_t from, time_t to, reading_s * out, long max);
+int GhParseLogLine(const char * p, const char * end, reading_s * rd, tzcache_s * tz);
+//@endcond
+#endif
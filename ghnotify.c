@@ -0,0 +1,579 @@
+/** @brief Alarm notifications delivered to local sinks by a worker thread
+*   @file ghnotify.c
+*   Alarm events are queued by the control loop and sent by a worker, so
+*   a slow or dead sink costs the loop no more than a short mutex hold.
+*   Sinks are listed in ghnotify.conf, one per line:
+*
+*       socket /run/ghalarm.sock            journal line to a Unix socket
+*       exec ./alarm.sh                     script EVENT NAME VALUE SEVERITY TIME REPEATS
+*       syslog                              one line at LOG_DAEMON
+*       http http://127.0.0.1:8080/alarms   JSON body in a POST
+*
+*   A notice that a sink refuses is retried with exponential backoff, up
+*   to NOTIFYRETRIES times, without holding back other sinks. Each sink
+*   still sees a rule's events in order. A rule is notified at most once
+*   per NOTIFYCOALESCE seconds: events arriving inside the window fold
+*   into the notice still waiting, which carries the latest state and a
+*   count of the repeats it stands for. When the queue is full new events
+*   are dropped and counted.
+*/
+
+#define _GNU_SOURCE //MSG_NOSIGNAL, must occur before library includes
+#include "ghnotify.h"
+#include <arpa/inet.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include <syslog.h>
+#include <unistd.h>
+
+static const char sinknames[][8] = {"socket","exec","syslog","http"};
+
+/**
+ * @brief Reads the monotonic clock that notice due times use
+ * @return double seconds
+ */
+static double GhNotifyNow(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/**
+ * @brief Splits an http://a.b.c.d[:port][/path] URL into an address and a path
+ * @param sk sink whose target holds the URL
+ * @return int 1 on success, 0 if it is not a numeric local URL
+ */
+static int GhNotifyParseUrl(notifysink_s * sk)
+{
+    char host[16];
+    const char * p;
+    char * end;
+    long port = 80;
+    int n = 0;
+
+    if(strncmp(sk->target, "http://localhost", 16) == 0)
+    {
+        strcpy(host, "127.0.0.1");
+        n = 16;
+    }
+    else if(sscanf(sk->target, "http://%15[0-9.]%n", host, &n) != 1)
+    {
+        return 0;
+    }
+    p = sk->target + n;
+    if(*p == ':')
+    {
+        port = strtol(p + 1, &end, 10);
+        if(end == p + 1 || port <= 0 || port > 65535)
+        {
+            return 0;
+        }
+        p = end;
+    }
+    if(*p != '\0' && *p != '/')
+    {
+        return 0;
+    }
+    memset(&sk->addr, 0, sizeof(sk->addr));
+    sk->addr.sin_family = AF_INET;
+    sk->addr.sin_port = htons(port);
+    strcpy(sk->path, (*p == '/') ? p : "/");
+    // Numeric only, a name lookup could stall the worker for far longer than the timeout
+    return inet_pton(AF_INET, host, &sk->addr.sin_addr) == 1;
+}
+
+/**
+ * @brief Reads the sink list
+ * @version CENG153, serial: 85048a62
+ * @author Devansh Patel
+ * @since 2026-10-19
+ * @param fname sink file, a missing file means no sinks
+ * @param nf notifier whose sink list is filled
+ * @return int 1 if every line was valid, 0 otherwise
+ */
+int GhNotifyLoad(const char * fname, notifier_s * nf)
+{
+    char line[ALARMLINESZ + NOTIFYTARGETSZ], kind[ALARMTOKSZ];
+    int lineno = 0, ok = 1, off, k;
+    notifysink_s * sk;
+    FILE *fp;
+
+    nf->nsinks = 0;
+    fp = fopen(fname,"r");
+    if(fp == NULL)
+    {
+        return 1;
+    }
+    while(fgets(line, sizeof(line), fp) != NULL)
+    {
+        lineno++;
+        line[strcspn(line, "#\r\n")] = '\0';
+        if(sscanf(line, " %15s%n", kind, &off) != 1)
+        {
+            continue;
+        }
+        for(k = SINKHTTP; k >= 0 && strcmp(kind, sinknames[k]) != 0; k--);
+        if(nf->nsinks == NOTIFYSINKS)
+        {
+            fprintf(stderr,"\n%s line %d: more than %d sinks\n", fname, lineno, NOTIFYSINKS);
+            ok = 0;
+            break;
+        }
+        sk = &nf->sinks[nf->nsinks];
+        sk->kind = k;
+        sk->target[0] = '\0';
+        off += strspn(line + off, " \t");
+        line[off + strcspn(line + off, " \t")] = '\0';
+        if(k < 0 || strlen(line + off) >= NOTIFYTARGETSZ || (k == SINKSYSLOG) != (line[off] == '\0'))
+        {
+            fprintf(stderr,"\n%s line %d: expected socket PATH, exec PATH, syslog or http URL\n", fname, lineno);
+            ok = 0;
+            continue;
+        }
+        strcpy(sk->target, line + off);
+        if(k == SINKHTTP && !GhNotifyParseUrl(sk))
+        {
+            fprintf(stderr,"\n%s line %d: expected http://a.b.c.d[:port][/path]\n", fname, lineno);
+            ok = 0;
+            continue;
+        }
+        nf->nsinks++;
+    }
+    fclose(fp);
+    return ok;
+}
+
+/**
+ * @brief Connects a socket within NOTIFYTIMEOUT and gives later sends and receives the same limit
+ * @param fd socket
+ * @param sa address
+ * @param len address length
+ * @return int 1 on success, 0 otherwise
+ */
+static int GhNotifyConnect(int fd, const struct sockaddr * sa, socklen_t len)
+{
+    struct timeval tv = {NOTIFYTIMEOUT / 1000, (NOTIFYTIMEOUT % 1000) * 1000};
+    struct pollfd pfd = {fd, POLLOUT, 0};
+    int err = 0, flags;
+    socklen_t elen = sizeof(err);
+
+    flags = fcntl(fd, F_GETFL);
+    fcntl(fd, F_SETFL, flags | O_NONBLOCK);
+    if(connect(fd, sa, len) != 0)
+    {
+        if(errno != EINPROGRESS && errno != EAGAIN)
+        {
+            return 0;
+        }
+        if(poll(&pfd, 1, NOTIFYTIMEOUT) != 1 || getsockopt(fd, SOL_SOCKET, SO_ERROR, &err, &elen) != 0 || err != 0)
+        {
+            return 0;
+        }
+    }
+    fcntl(fd, F_SETFL, flags);
+    setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv));
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+    return 1;
+}
+
+/**
+ * @brief Sends a journal line to a Unix socket, datagram or stream
+ * @param sk sink
+ * @param line journal line
+ * @param len line length
+ * @return int 1 if the line was sent, 0 otherwise
+ */
+static int GhNotifySocket(const notifysink_s * sk, const char * line, int len)
+{
+    struct sockaddr_un sa = {0};
+    int fd, ok;
+
+    sa.sun_family = AF_UNIX;
+    strncpy(sa.sun_path, sk->target, sizeof(sa.sun_path) - 1);
+    fd = socket(AF_UNIX, SOCK_DGRAM | SOCK_CLOEXEC, 0);
+    ok = fd >= 0 && GhNotifyConnect(fd, (struct sockaddr *) &sa, sizeof(sa));
+    if(!ok && errno == EPROTOTYPE)
+    {
+        close(fd);
+        fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        ok = fd >= 0 && GhNotifyConnect(fd, (struct sockaddr *) &sa, sizeof(sa));
+    }
+    ok = ok && send(fd, line, len, MSG_NOSIGNAL) == len;
+    if(fd >= 0)
+    {
+        close(fd);
+    }
+    return ok;
+}
+
+/**
+ * @brief Runs a sink script with the event as arguments, killing it after NOTIFYTIMEOUT
+ * @param sk sink
+ * @param nt notice
+ * @return int 1 if the script exited with status 0, 0 otherwise
+ */
+static int GhNotifyExec(const notifysink_s * sk, const notice_s * nt)
+{
+    char value[16], sev[12], stamp[24], reps[12];
+    struct timespec tick = {0, 10000000};
+    sigset_t none;
+    int status, waited;
+    pid_t pid, done = 0;
+
+    // Everything the child needs is prepared before the fork
+    snprintf(value, sizeof(value), "%.1f", nt->ev.value);
+    snprintf(sev, sizeof(sev), "%d", nt->ev.severity);
+    snprintf(stamp, sizeof(stamp), "%ld", (long) nt->ev.etime);
+    snprintf(reps, sizeof(reps), "%d", nt->repeats);
+    sigemptyset(&none);
+    pid = fork();
+    if(pid == 0)
+    {
+        // The controller blocks signals it serves through signalfd, the script should not inherit that
+        sigprocmask(SIG_SETMASK, &none, NULL);
+        execl(sk->target, sk->target, nt->ev.raised ? "RAISED" : "CLEARED", alarmnames[nt->ev.code],
+              value, sev, stamp, reps, (char *) NULL);
+        _exit(127);
+    }
+    if(pid < 0)
+    {
+        return 0;
+    }
+    for(waited = 0; waited < NOTIFYTIMEOUT && (done = waitpid(pid, &status, WNOHANG)) == 0; waited += 10)
+    {
+        nanosleep(&tick, NULL);
+    }
+    if(done == 0)
+    {
+        kill(pid, SIGKILL);
+        waitpid(pid, &status, 0);
+        return 0;
+    }
+    return done == pid && WIFEXITED(status) && WEXITSTATUS(status) == 0;
+}
+
+/**
+ * @brief POSTs the event as JSON to a local HTTP endpoint
+ * @param sk sink
+ * @param nt notice
+ * @return int 1 on a 2xx reply, 0 otherwise
+ */
+static int GhNotifyHttp(const notifysink_s * sk, const notice_s * nt)
+{
+    char body[NOTIFYMSGSZ / 2], req[NOTIFYMSGSZ + NOTIFYTARGETSZ], reply[16] = {0};
+    int fd, blen, rlen, ok;
+
+    blen = snprintf(body, sizeof(body),
+                    "{\"time\":%ld,\"event\":\"%s\",\"alarm\":\"%s\",\"value\":%.1f,\"severity\":%d,\"repeats\":%d}",
+                    (long) nt->ev.etime, nt->ev.raised ? "RAISED" : "CLEARED", alarmnames[nt->ev.code],
+                    nt->ev.value, nt->ev.severity, nt->repeats);
+    rlen = snprintf(req, sizeof(req),
+                    "POST %s HTTP/1.0\r\nHost: %s\r\nContent-Type: application/json\r\n"
+                    "Content-Length: %d\r\nConnection: close\r\n\r\n%s",
+                    sk->path, inet_ntoa(sk->addr.sin_addr), blen, body);
+    fd = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if(fd < 0)
+    {
+        return 0;
+    }
+    ok = GhNotifyConnect(fd, (struct sockaddr *) &sk->addr, sizeof(sk->addr)) &&
+         send(fd, req, rlen, MSG_NOSIGNAL) == rlen &&
+         recv(fd, reply, sizeof(reply) - 1, MSG_WAITALL) >= 12 &&
+         strncmp(reply, "HTTP/1.", 7) == 0 && reply[9] == '2';
+    close(fd);
+    return ok;
+}
+
+/**
+ * @brief Offers a notice to the sinks in its pending mask, clearing the bits of those that took it
+ * @param nf notifier
+ * @param nt notice, pending holds the sinks to try
+ * @return void
+ */
+static void GhNotifyDeliver(notifier_s * nf, notice_s * nt)
+{
+    char line[ALARMLINESZ];
+    int i, len, ok;
+
+    len = GhAlarmFormat(line, sizeof(line), &nt->ev);
+    for(i = 0; i < nf->nsinks; i++)
+    {
+        if(!(nt->pending & (1u << i)))
+        {
+            continue;
+        }
+        switch(nf->sinks[i].kind)
+        {
+        case SINKSOCKET:
+            ok = GhNotifySocket(&nf->sinks[i], line, len);
+            break;
+        case SINKEXEC:
+            ok = GhNotifyExec(&nf->sinks[i], nt);
+            break;
+        case SINKSYSLOG:
+            line[len - 1] = '\0';
+            syslog(nt->ev.raised ? (nt->ev.severity > 1 ? LOG_CRIT : LOG_WARNING) : LOG_NOTICE,
+                   "alarm %s repeats %d", line, nt->repeats);
+            line[len - 1] = '\n';
+            ok = 1;
+            break;
+        default:
+            ok = GhNotifyHttp(&nf->sinks[i], nt);
+            break;
+        }
+        if(ok)
+        {
+            nt->pending &= ~(1u << i);
+        }
+    }
+}
+
+/**
+ * @brief Takes a notice out of the queue, closing the gap behind it
+ * @param nf notifier, locked
+ * @param idx position of the notice counted from the head
+ * @return void
+ */
+static void GhNotifyRemove(notifier_s * nf, int idx)
+{
+    int i;
+
+    for(i = idx; i < nf->qcount - 1; i++)
+    {
+        nf->queue[(nf->qhead + i) % NOTIFYQUEUE] = nf->queue[(nf->qhead + i + 1) % NOTIFYQUEUE];
+    }
+    nf->qcount--;
+}
+
+/**
+ * @brief Delivery worker, sends due notices and schedules retries
+ * @param arg notifier
+ * @return NULL
+ */
+static void * GhNotifyWorker(void * arg)
+{
+    notifier_s * nf = arg;
+    notice_s nt, * q = NULL, * p;
+    uint32_t held, mask;
+    double now, next, wait;
+    struct timespec ts;
+    int i, idx;
+
+    pthread_mutex_lock(&nf->lock);
+    while(!nf->stop)
+    {
+        // First due notice with a sink that no earlier notice of its rule still holds
+        now = GhNotifyNow();
+        next = 0;
+        mask = 0;
+        for(idx = 0; idx < nf->qcount; idx++)
+        {
+            q = &nf->queue[(nf->qhead + idx) % NOTIFYQUEUE];
+            held = 0;
+            for(i = 0; i < idx; i++)
+            {
+                p = &nf->queue[(nf->qhead + i) % NOTIFYQUEUE];
+                held |= (p->ev.rule == q->ev.rule) ? p->pending : 0;
+            }
+            mask = q->pending & ~held;
+            if(mask != 0 && q->due <= now)
+            {
+                break;
+            }
+            if(mask != 0 && (next == 0 || q->due < next))
+            {
+                next = q->due;
+            }
+        }
+        if(idx == nf->qcount)
+        {
+            if(next == 0)
+            {
+                pthread_cond_wait(&nf->wake, &nf->lock);
+            }
+            else
+            {
+                clock_gettime(CLOCK_MONOTONIC, &ts);
+                wait = next - now;
+                ts.tv_sec += (time_t) wait;
+                ts.tv_nsec += (long) ((wait - (time_t) wait) * 1e9);
+                if(ts.tv_nsec >= 1000000000)
+                {
+                    ts.tv_sec++;
+                    ts.tv_nsec -= 1000000000;
+                }
+                pthread_cond_timedwait(&nf->wake, &nf->lock, &ts);
+            }
+            continue;
+        }
+
+        q->busy = 1;
+        nt = *q;
+        nt.pending = mask;
+        pthread_mutex_unlock(&nf->lock);
+        GhNotifyDeliver(nf, &nt);
+        pthread_mutex_lock(&nf->lock);
+
+        // Only this thread removes notices, so idx still names the same one
+        q = &nf->queue[(nf->qhead + idx) % NOTIFYQUEUE];
+        q->busy = 0;
+        q->pending = (q->pending & ~mask) | nt.pending;
+        if(nt.pending != 0)
+        {
+            q->attempts++;
+            wait = NOTIFYBACKOFF * (1 << (q->attempts - 1));
+            q->due = now + ((wait < NOTIFYBACKOFFMAX) ? wait : NOTIFYBACKOFFMAX);
+        }
+        if(q->pending == 0 || q->attempts > NOTIFYRETRIES)
+        {
+            for(i = 0; i < nf->nsinks; i++)
+            {
+                nf->failed += (q->pending >> i) & 1;
+            }
+            GhNotifyRemove(nf, idx);
+        }
+    }
+    pthread_mutex_unlock(&nf->lock);
+    return NULL;
+}
+
+/**
+ * @brief Reads the sink list and starts the delivery worker
+ * @version CENG153, serial: 85048a62
+ * @author Devansh Patel
+ * @since 2026-10-19
+ * @param nf notifier to initialise
+ * @param fname sink file
+ * @return int 1 on success, 0 if the sink file was bad or the worker could not be started
+ */
+int GhNotifyOpen(notifier_s * nf, const char * fname)
+{
+    pthread_condattr_t ca;
+    int i, ok;
+
+    memset(nf, 0, sizeof(*nf));
+    ok = GhNotifyLoad(fname, nf);
+    nf->all = (1u << nf->nsinks) - 1;
+    for(i = 0; i < nf->nsinks; i++)
+    {
+        if(nf->sinks[i].kind == SINKSYSLOG)
+        {
+            openlog("ghc", LOG_PID, LOG_DAEMON);
+        }
+    }
+    if(nf->nsinks == 0)
+    {
+        return ok;
+    }
+
+    pthread_mutex_init(&nf->lock, NULL);
+    pthread_condattr_init(&ca);
+    pthread_condattr_setclock(&ca, CLOCK_MONOTONIC);
+    pthread_cond_init(&nf->wake, &ca);
+    pthread_condattr_destroy(&ca);
+    nf->running = pthread_create(&nf->worker, NULL, GhNotifyWorker, nf) == 0;
+    if(!nf->running)
+    {
+        fprintf(stderr,"\nCan't start the alarm notification thread\n");
+        nf->nsinks = 0;
+    }
+    return ok && nf->running;
+}
+
+/**
+ * @brief Queues the events of the last alarm table update, never waiting on a sink
+ * @version CENG153, serial: 85048a62
+ * @author Devansh Patel
+ * @since 2026-10-19
+ * @param nf notifier from GhNotifyOpen
+ * @param at alarm table after GhAlarmTableUpdate
+ * @return int number of events dropped because the queue was full
+ */
+int GhNotifyPost(notifier_s * nf, const alarmtable_s * at)
+{
+    const alarmevent_s * ev;
+    notice_s * q;
+    double now;
+    int i, j, dropped = 0;
+
+    if(!nf->running || at->nevents == 0)
+    {
+        return 0;
+    }
+    now = GhNotifyNow();
+    pthread_mutex_lock(&nf->lock);
+    for(i = 0; i < at->nevents; i++)
+    {
+        ev = &at->events[i];
+        nf->posted++;
+
+        // The rule's latest notice, folded into if no sink has seen it yet
+        for(j = nf->qcount - 1; j >= 0; j--)
+        {
+            q = &nf->queue[(nf->qhead + j) % NOTIFYQUEUE];
+            if(q->ev.rule == ev->rule && q->ev.code == ev->code)
+            {
+                break;
+            }
+        }
+        if(j >= 0 && !q->busy && q->pending == nf->all)
+        {
+            q->ev = *ev;
+            q->repeats++;
+            nf->coalesced++;
+            continue;
+        }
+        if(nf->qcount == NOTIFYQUEUE)
+        {
+            nf->dropped++;
+            dropped++;
+            continue;
+        }
+
+        q = &nf->queue[(nf->qhead + nf->qcount++) % NOTIFYQUEUE];
+        q->ev = *ev;
+        q->repeats = 0;
+        q->attempts = 0;
+        q->busy = 0;
+        q->pending = nf->all;
+        // One notice per rule per window, later events wait in it to be folded
+        q->due = now;
+        if(nf->lastdue[ev->rule] != 0 && nf->lastdue[ev->rule] + NOTIFYCOALESCE > now)
+        {
+            q->due = nf->lastdue[ev->rule] + NOTIFYCOALESCE;
+        }
+        nf->lastdue[ev->rule] = q->due;
+    }
+    pthread_cond_signal(&nf->wake);
+    pthread_mutex_unlock(&nf->lock);
+    return dropped;
+}
+
+/**
+ * @brief Stops the delivery worker, abandoning notices still queued
+ * @version CENG153, serial: 85048a62
+ * @author Devansh Patel
+ * @since 2026-10-19
+ * @param nf notifier
+ * @return void
+ */
+void GhNotifyClose(notifier_s * nf)
+{
+    if(nf->running)
+    {
+        pthread_mutex_lock(&nf->lock);
+        nf->stop = 1;
+        pthread_cond_signal(&nf->wake);
+        pthread_mutex_unlock(&nf->lock);
+        pthread_join(nf->worker, NULL);
+        nf->running = 0;
+    }
+    closelog();
+}
@@ -0,0 +1,74 @@
+/** @brief Alarm notification constants, structures, function prototypes
+*   @file ghnotify.h
+*/
+
+#ifndef GHNOTIFY_H
+#define GHNOTIFY_H
+
+// Includes
+#include <stdint.h>
+#include <pthread.h>
+#include <netinet/in.h>
+#include "ghalarm.h"
+
+// Constants
+#define NOTIFYFILE "ghnotify.conf"
+#define NOTIFYSINKS 8
+#define NOTIFYQUEUE 64
+#define NOTIFYTARGETSZ 108
+#define NOTIFYMSGSZ 512
+#define NOTIFYRETRIES 6
+#define NOTIFYBACKOFF 1.0
+#define NOTIFYBACKOFFMAX 300.0
+#define NOTIFYCOALESCE 60
+#define NOTIFYTIMEOUT 2000
+
+// Enumerated Types
+typedef enum { SINKSOCKET, SINKEXEC, SINKSYSLOG, SINKHTTP } sink_e;
+
+// Structures
+typedef struct notifysink
+{
+    sink_e kind;
+    char target[NOTIFYTARGETSZ];
+    char path[NOTIFYTARGETSZ];
+    struct sockaddr_in addr;
+} notifysink_s;
+
+typedef struct notice
+{
+    alarmevent_s ev;
+    int repeats;
+    int attempts;
+    int busy;
+    uint32_t pending;
+    double due;
+} notice_s;
+
+typedef struct notifier
+{
+    int nsinks;
+    uint32_t all;
+    notifysink_s sinks[NOTIFYSINKS];
+    double lastdue[ALARMRULES];
+    notice_s queue[NOTIFYQUEUE];
+    int qhead;
+    int qcount;
+    unsigned long posted;
+    unsigned long coalesced;
+    unsigned long dropped;
+    unsigned long failed;
+    pthread_t worker;
+    pthread_mutex_t lock;
+    pthread_cond_t wake;
+    int running;
+    int stop;
+} notifier_s;
+
+//@cond INTERNAL
+int GhNotifyLoad(const char * fname, notifier_s * nf);
+int GhNotifyOpen(notifier_s * nf, const char * fname);
+int GhNotifyPost(notifier_s * nf, const alarmtable_s * at);
+void GhNotifyClose(notifier_s * nf);
+//@endcond
+#endif
@@ -0,0 +1,613 @@
+/** @brief Daily log partitions with background compression and a sparse index
+*   @file ghpart.c
+*   Readings go to one binary log per local day, ghdata-YYYYMMDD.bin.
+*   Every PARTIDXSTRIDE commit batches the time and offset of the batch
+*   are appended to ghdata-YYYYMMDD.idx. When the day closes a worker
+*   thread at idle priority rewrites the partition as compressed blocks,
+*   ghdata-YYYYMMDD.ghz, with an index entry per block, then removes the
+*   .bin. Range reads open the partitions of the days they cover and use
+*   the index to seek close to the start time.
+*
+*   A backward clock step logs readings to the open partition with a time
+*   of an earlier day. They are kept and compressed with the rest, in time
+*   order. Since a step across midnight leaves readings of a day in the
+*   next day's partition, range reads also look there and sort what they
+*   find. Readings a step put more than a day back are only found by
+*   reading their partition whole with GhBinLogRead or the block decoder.
+*
+*   Index layout: "GHIX", u8 kind (PARTIDXBIN or PARTIDXGHZ), 3 reserved
+*   bytes, then i64 time, i64 offset pairs, all little-endian. The time is
+*   the latest reading time up to and including the first reading at the
+*   offset, so it never decreases even when the clock does.
+*/
+
+#define _GNU_SOURCE //SCHED_IDLE, must occur before library includes
+#include "ghpart.h"
+#include "ghblock.h"
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <sched.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/**
+ * @brief Builds the file name of a partition
+ * @param buf destination, PARTNAMESZ bytes
+ * @param day YYYYMMDD
+ * @param ext extension including the dot
+ * @return void
+ */
+static void GhPartName(char * buf, const char * day, const char * ext)
+{
+    snprintf(buf, PARTNAMESZ, PARTPREFIX "%s%s", day, ext);
+}
+
+/**
+ * @brief Finds the local day a time falls in
+ * @param t time
+ * @param day YYYYMMDD of that day
+ * @return int64_t start of the following local day
+ */
+static int64_t GhPartDay(time_t t, char * day)
+{
+    struct tm lt;
+
+    localtime_r(&t, &lt);
+    strftime(day, PARTDAYSZ, "%Y%m%d", &lt);
+    lt.tm_mday++;
+    lt.tm_hour = 0;
+    lt.tm_min = 0;
+    lt.tm_sec = 0;
+    lt.tm_isdst = -1;
+    return mktime(&lt);
+}
+
+/**
+ * @brief Start and end of a YYYYMMDD local day
+ * @param day YYYYMMDD
+ * @param from start of the day
+ * @param to start of the next day
+ * @return int 1 if day is a valid day name, 0 otherwise
+ */
+static int GhPartDayRange(const char * day, time_t * from, time_t * to)
+{
+    struct tm lt = {0};
+    char next[PARTDAYSZ];
+    int ymd;
+
+    if(strlen(day) != PARTDAYSZ - 1 || sscanf(day, "%8d", &ymd) != 1)
+    {
+        return 0;
+    }
+    lt.tm_year = ymd / 10000 - 1900;
+    lt.tm_mon = ymd / 100 % 100 - 1;
+    lt.tm_mday = ymd % 100;
+    lt.tm_isdst = -1;
+    *from = mktime(&lt);
+    *to = GhPartDay(*from, next);
+    return *from != (time_t) -1;
+}
+
+/**
+ * @brief Opens an index for appending, starting it over if it is missing or of another kind
+ * @param name index file name
+ * @param kind PARTIDXBIN or PARTIDXGHZ
+ * @param trunc 1 to always start a new index
+ * @return int file descriptor, -1 on error
+ */
+static int GhPartIdxOpen(const char * name, int kind, int trunc)
+{
+    uint8_t hdr[PARTIDXHDRSZ] = {0};
+    int fd;
+
+    fd = open(name, O_RDWR | O_CREAT | (trunc ? O_TRUNC : 0), 0644);
+    if(fd < 0)
+    {
+        return -1;
+    }
+    if(pread(fd, hdr, sizeof(hdr), 0) == sizeof(hdr) && memcmp(hdr, PARTIDXMAGIC, 4) == 0 && hdr[4] == kind)
+    {
+        lseek(fd, 0, SEEK_END);
+        return fd;
+    }
+    memset(hdr, 0, sizeof(hdr));
+    memcpy(hdr, PARTIDXMAGIC, 4);
+    hdr[4] = kind;
+    if(ftruncate(fd, 0) != 0 || pwrite(fd, hdr, sizeof(hdr), 0) != sizeof(hdr))
+    {
+        close(fd);
+        return -1;
+    }
+    lseek(fd, 0, SEEK_END);
+    return fd;
+}
+
+/**
+ * @brief Appends one time to offset entry to an index
+ * @param fd open index
+ * @param t latest reading time up to the offset
+ * @param off offset in the partition
+ * @return int 1 on success, 0 on a write error
+ */
+static int GhPartIdxPut(int fd, int64_t t, int64_t off)
+{
+    uint8_t ent[PARTIDXENTSZ];
+
+    GhPutLe64(ent, (uint64_t) t);
+    GhPutLe64(ent + 8, (uint64_t) off);
+    return fd >= 0 && write(fd, ent, sizeof(ent)) == sizeof(ent);
+}
+
+/**
+ * @brief Looks up where to start reading a partition for a given time
+ * @param name index file name
+ * @param kind kind of partition the index must describe
+ * @param from time to start at
+ * @return off_t offset of the last indexed position before from, 0 for the start
+ */
+static off_t GhPartSeek(const char * name, int kind, time_t from)
+{
+    uint8_t * idx;
+    struct stat st;
+    off_t best = 0;
+    size_t i;
+    int fd;
+
+    fd = open(name, O_RDONLY);
+    if(fd < 0)
+    {
+        return 0;
+    }
+    if(fstat(fd, &st) != 0 || st.st_size < PARTIDXHDRSZ || (idx = malloc(st.st_size)) == NULL)
+    {
+        close(fd);
+        return 0;
+    }
+    if(pread(fd, idx, st.st_size, 0) == st.st_size && memcmp(idx, PARTIDXMAGIC, 4) == 0 && idx[4] == kind)
+    {
+        for(i = PARTIDXHDRSZ; i + PARTIDXENTSZ <= (size_t) st.st_size; i += PARTIDXENTSZ)
+        {
+            if((int64_t) GhGetLe64(idx + i) >= (int64_t) from)
+            {
+                break;
+            }
+            best = (off_t) GhGetLe64(idx + i + 8);
+        }
+    }
+    free(idx);
+    close(fd);
+    return best;
+}
+
+/**
+ * @brief Finishes a block and writes it and its index entry
+ * @param enc encoder holding at least one reading
+ * @param fd compressed partition
+ * @param idxfd its index
+ * @param off offset of the block, advanced past it
+ * @return int 1 on success, 0 on a write error
+ */
+static int GhPartPutBlock(blockenc_s * enc, int fd, int idxfd, off_t * off)
+{
+    size_t len = GhBlockFinish(enc);
+    int ok;
+
+    ok = GhPartIdxPut(idxfd, enc->first, *off) && write(fd, enc->buf, len) == (ssize_t) len;
+    *off += len;
+    GhBlockBegin(enc);
+    return ok;
+}
+
+/**
+ * @brief Orders readings by time for qsort
+ * @param a reading
+ * @param b reading
+ * @return int <0, 0 or >0 as a is earlier, as early or later than b
+ */
+static int GhPartTimeCmp(const void * a, const void * b)
+{
+    time_t ta = ((const reading_s *) a)->rtime;
+    time_t tb = ((const reading_s *) b)->rtime;
+
+    return (ta > tb) - (ta < tb);
+}
+
+/**
+ * @brief Rewrites a closed day's binary partition as compressed blocks
+ * @version CENG153, serial: 85048a62
+ * @author Devansh Patel
+ * @since 2026-10-19
+ * @param day YYYYMMDD of the partition
+ * @return int 1 if the partition was compressed and the .bin removed, 0 otherwise
+ */
+int GhPartCompress(const char * day)
+{
+    char bin[PARTNAMESZ], ghz[PARTNAMESZ], idx[PARTNAMESZ], ghztmp[PARTNAMESZ], idxtmp[PARTNAMESZ];
+    blockenc_s * enc = NULL;
+    reading_s * recs = NULL;
+    struct stat st;
+    time_t from, to;
+    off_t off = 0;
+    long n, i;
+    int fd = -1, idxfd = -1, full, ok = 0;
+
+    GhPartName(bin, day, ".bin");
+    GhPartName(ghz, day, ".ghz");
+    GhPartName(idx, day, ".idx");
+    GhPartName(ghztmp, day, ".ghz.tmp");
+    GhPartName(idxtmp, day, ".idx.tmp");
+    if(!GhPartDayRange(day, &from, &to) || stat(bin, &st) != 0)
+    {
+        return 0;
+    }
+
+    recs = malloc((st.st_size / LOGRECSZ + 1) * sizeof(reading_s));
+    enc = malloc(sizeof(blockenc_s));
+    if(recs == NULL || enc == NULL)
+    {
+        goto done;
+    }
+    // Every valid record is kept, also those a clock step put outside the day, since the .bin is deleted
+    to = (time_t) (((uint64_t) 1 << (sizeof(time_t) * 8 - 1)) - 1);
+    from = -to - 1;
+    n = GhBinLogRead(bin, 0, from, to, recs, st.st_size / LOGRECSZ + 1);
+    if(n <= 0)
+    {
+        fprintf(stderr,"\nPartition %s has no readable records, left uncompressed\n", bin);
+        goto done;
+    }
+    // The block index is searched by time
+    qsort(recs, n, sizeof(reading_s), GhPartTimeCmp);
+
+    fd = open(ghztmp, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    idxfd = GhPartIdxOpen(idxtmp, PARTIDXGHZ, 1);
+    if(fd < 0 || idxfd < 0)
+    {
+        goto done;
+    }
+    ok = 1;
+    GhBlockBegin(enc);
+    for(i = 0; ok && i < n; i++)
+    {
+        full = GhBlockAdd(enc, &recs[i]);
+        if(full < 0)
+        {
+            ok = GhPartPutBlock(enc, fd, idxfd, &off);
+            full = GhBlockAdd(enc, &recs[i]);
+        }
+        if(full > 0)
+        {
+            ok = ok && GhPartPutBlock(enc, fd, idxfd, &off);
+        }
+    }
+    if(ok && enc->count > 0)
+    {
+        ok = GhPartPutBlock(enc, fd, idxfd, &off);
+    }
+
+    // The .bin stays authoritative until both replacements are durable
+    ok = ok && fsync(fd) == 0 && fsync(idxfd) == 0;
+    ok = ok && rename(ghztmp, ghz) == 0 && rename(idxtmp, idx) == 0;
+    if(ok)
+    {
+        unlink(bin);
+    }
+
+done:
+    if(fd >= 0)
+    {
+        close(fd);
+    }
+    if(idxfd >= 0)
+    {
+        close(idxfd);
+    }
+    if(!ok)
+    {
+        unlink(ghztmp);
+        unlink(idxtmp);
+    }
+    free(enc);
+    free(recs);
+    return ok;
+}
+
+/**
+ * @brief Queues a closed day for the compression worker
+ * @param pl partitioned log
+ * @param day YYYYMMDD
+ * @return void
+ */
+static void GhPartEnqueue(partlog_s * pl, const char * day)
+{
+    pthread_mutex_lock(&pl->lock);
+    if(pl->qcount < PARTQUEUE)
+    {
+        strcpy(pl->queue[(pl->qhead + pl->qcount) % PARTQUEUE], day);
+        pl->qcount++;
+        pthread_cond_signal(&pl->wake);
+    }
+    else
+    {
+        fprintf(stderr,"\nCompression queue full, %s%s.bin left uncompressed until the next start\n", PARTPREFIX, day);
+    }
+    pthread_mutex_unlock(&pl->lock);
+}
+
+/**
+ * @brief Compression worker, runs at idle priority so it never competes with the control loop
+ * @param arg partitioned log
+ * @return NULL
+ */
+static void * GhPartWorker(void * arg)
+{
+    partlog_s * pl = arg;
+    struct sched_param sp = {0};
+    char day[PARTDAYSZ];
+
+    if(pthread_setschedparam(pthread_self(), SCHED_IDLE, &sp) != 0)
+    {
+        setpriority(PRIO_PROCESS, 0, 19);
+    }
+
+    pthread_mutex_lock(&pl->lock);
+    while(!pl->stop)
+    {
+        if(pl->qcount == 0)
+        {
+            pthread_cond_wait(&pl->wake, &pl->lock);
+            continue;
+        }
+        strcpy(day, pl->queue[pl->qhead]);
+        pl->qhead = (pl->qhead + 1) % PARTQUEUE;
+        pl->qcount--;
+        pthread_mutex_unlock(&pl->lock);
+        GhPartCompress(day);
+        pthread_mutex_lock(&pl->lock);
+    }
+    pthread_mutex_unlock(&pl->lock);
+    return NULL;
+}
+
+/**
+ * @brief Opens the partition of the day a time falls in
+ * @param pl partitioned log
+ * @param t time of the reading about to be logged
+ * @return int 1 on success, 0 otherwise
+ */
+static int GhPartStart(partlog_s * pl, time_t t)
+{
+    char name[PARTNAMESZ];
+
+    pl->dayend = GhPartDay(t, pl->day);
+    pl->batches = 0;
+    pl->latest = t;
+    GhPartName(name, pl->day, ".idx");
+    pl->idxfd = GhPartIdxOpen(name, PARTIDXBIN, 0);
+    GhPartName(name, pl->day, ".bin");
+    return GhBinLogOpen(&pl->log, name, LOGBATCH);
+}
+
+/**
+ * @brief Starts the compression worker and queues days left uncompressed by an earlier run
+ * @version CENG153, serial: 85048a62
+ * @author Devansh Patel
+ * @since 2026-10-19
+ * @param pl partitioned log to initialise
+ * @return int 1 on success, 0 if the worker could not be started
+ */
+int GhPartOpen(partlog_s * pl)
+{
+    struct dirent ** names;
+    char today[PARTDAYSZ];
+    size_t plen = strlen(PARTPREFIX);
+    int i, n;
+
+    pl->log.fd = -1;
+    pl->idxfd = -1;
+    pl->dayend = 0;
+    pl->qhead = 0;
+    pl->qcount = 0;
+    pl->stop = 0;
+    pthread_mutex_init(&pl->lock, NULL);
+    pthread_cond_init(&pl->wake, NULL);
+
+    GhPartDay(time(NULL), today);
+    n = scandir(".", &names, NULL, alphasort);
+    for(i = 0; i < n; i++)
+    {
+        if(strncmp(names[i]->d_name, PARTPREFIX, plen) == 0 && strlen(names[i]->d_name) == plen + 12 &&
+           strcmp(names[i]->d_name + plen + 8, ".bin") == 0 && strncmp(names[i]->d_name + plen, today, 8) != 0)
+        {
+            names[i]->d_name[plen + 8] = '\0';
+            GhPartEnqueue(pl, names[i]->d_name + plen);
+        }
+        free(names[i]);
+    }
+    if(n >= 0)
+    {
+        free(names);
+    }
+
+    pl->running = pthread_create(&pl->worker, NULL, GhPartWorker, pl) == 0;
+    if(!pl->running)
+    {
+        fprintf(stderr,"\nCan't start the partition compression thread\n");
+    }
+    return pl->running;
+}
+
+/**
+ * @brief Logs one reading to its day's partition, handing the previous day to the worker
+ * @version CENG153, serial: 85048a62
+ * @author Devansh Patel
+ * @since 2026-10-19
+ * @param pl partitioned log
+ * @param rd reading to log
+ * @return int 1 on success, 0 on an I/O error
+ */
+int GhPartAppend(partlog_s * pl, const reading_s * rd)
+{
+    if(rd->rtime >= pl->dayend || pl->log.fd < 0)
+    {
+        if(pl->log.fd >= 0)
+        {
+            GhBinLogClose(&pl->log);
+            close(pl->idxfd);
+            GhPartEnqueue(pl, pl->day);
+        }
+        if(!GhPartStart(pl, rd->rtime))
+        {
+            return 0;
+        }
+    }
+
+    if(rd->rtime > pl->latest)
+    {
+        pl->latest = rd->rtime;
+    }
+    // A sparse index entry at the start of every PARTIDXSTRIDE-th commit batch
+    if(pl->log.used == 0 && pl->batches++ % PARTIDXSTRIDE == 0)
+    {
+        GhPartIdxPut(pl->idxfd, pl->latest, pl->log.end);
+    }
+    return GhBinLogAppend(&pl->log, rd, 1);
+}
+
+/**
+ * @brief Commits the open batch, stops the worker and closes the partition
+ * @version CENG153, serial: 85048a62
+ * @author Devansh Patel
+ * @since 2026-10-19
+ * @param pl partitioned log
+ * @return int 1 on success, 0 if the open batch could not be committed
+ */
+int GhPartClose(partlog_s * pl)
+{
+    int ok = 1;
+
+    if(pl->running)
+    {
+        pthread_mutex_lock(&pl->lock);
+        pl->stop = 1;
+        pthread_cond_signal(&pl->wake);
+        pthread_mutex_unlock(&pl->lock);
+        pthread_join(pl->worker, NULL);
+        pl->running = 0;
+    }
+    if(pl->log.fd >= 0)
+    {
+        ok = GhBinLogClose(&pl->log);
+        close(pl->idxfd);
+    }
+    return ok;
+}
+
+/**
+ * @brief Reads a time range from a compressed partition
+ * @param name .ghz file name
+ * @param start offset of the first block to look at
+ * @param from earliest time
+ * @param to end of the range
+ * @param out readings read
+ * @param max capacity of out
+ * @return long number of readings, -1 if the partition cannot be read
+ */
+static long GhPartReadGhz(const char * name, off_t start, time_t from, time_t to, reading_s * out, long max)
+{
+    uint8_t * blk = malloc(BLOCKMAXSZ);
+    reading_s * tmp = malloc(BLOCKSAMPLES * sizeof(reading_s));
+    blockinfo_s info;
+    long n = 0;
+    int fd, k, j;
+
+    fd = open(name, O_RDONLY);
+    if(fd < 0 || blk == NULL || tmp == NULL || lseek(fd, start, SEEK_SET) < 0)
+    {
+        n = -1;
+    }
+    while(n >= 0 && n < max && GhBlockReadNext(fd, blk, BLOCKMAXSZ, &info) == 1 && info.first < to)
+    {
+        if(info.last < from)
+        {
+            continue;
+        }
+        k = GhBlockDecode(blk, info.size, tmp, BLOCKSAMPLES);
+        for(j = 0; j < k && n < max; j++)
+        {
+            if(tmp[j].rtime >= from && tmp[j].rtime < to)
+            {
+                out[n++] = tmp[j];
+            }
+        }
+    }
+    if(fd >= 0)
+    {
+        close(fd);
+    }
+    free(tmp);
+    free(blk);
+    return n;
+}
+
+/**
+ * @brief Reads the readings in [from, to) from one day's partition
+ * @param day YYYYMMDD of the partition
+ * @param from earliest time
+ * @param to end of the range
+ * @param out readings read
+ * @param max capacity of out
+ * @return long number of readings, 0 if the partition is missing or unreadable
+ */
+static long GhPartReadDay(const char * day, time_t from, time_t to, reading_s * out, long max)
+{
+    char bin[PARTNAMESZ], ghz[PARTNAMESZ], idx[PARTNAMESZ];
+    long r = 0;
+
+    GhPartName(bin, day, ".bin");
+    GhPartName(ghz, day, ".ghz");
+    GhPartName(idx, day, ".idx");
+    if(access(bin, R_OK) == 0)
+    {
+        r = GhBinLogRead(bin, GhPartSeek(idx, PARTIDXBIN, from), from, to, out, max);
+    }
+    else if(access(ghz, R_OK) == 0)
+    {
+        r = GhPartReadGhz(ghz, GhPartSeek(idx, PARTIDXGHZ, from), from, to, out, max);
+    }
+    return (r > 0) ? r : 0;
+}
+
+/**
+ * @brief Reads the readings in [from, to) from the partitions of the days in range
+ * @version CENG153, serial: 85048a62
+ * @author Devansh Patel
+ * @since 2026-10-19
+ * @param from earliest time
+ * @param to end of the range
+ * @param out readings read, oldest first
+ * @param max capacity of out
+ * @return long number of readings
+ */
+long GhPartRead(time_t from, time_t to, reading_s * out, long max)
+{
+    char day[PARTDAYSZ], next[PARTDAYSZ];
+    time_t t = from, dayend, end;
+    long n = 0, r;
+
+    while(t < to && n < max)
+    {
+        dayend = GhPartDay(t, day);
+        GhPartDay(dayend, next);
+        end = (to < dayend) ? to : dayend;
+        // Readings of the day a clock step left in the next partition come first there, then sort in
+        r = GhPartReadDay(day, t, end, out + n, max - n);
+        r += GhPartReadDay(next, t, end, out + n + r, max - n - r);
+        qsort(out + n, r, sizeof(reading_s), GhPartTimeCmp);
+        n += r;
+        t = dayend;
+    }
+    return n;
+}
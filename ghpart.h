@@ -0,0 +1,52 @@
+/** @brief Daily log partition constants, structures, function prototypes
+*   @file ghpart.h
+*/
+
+#ifndef GHPART_H
+#define GHPART_H
+
+// Includes
+#include <stdint.h>
+#include <pthread.h>
+#include "ghcontrol.h"
+#include "ghlog.h"
+
+// Constants
+#define PARTPREFIX "ghdata-"
+#define PARTDAYSZ 9
+#define PARTNAMESZ 64
+#define PARTQUEUE 16
+#define PARTIDXSTRIDE 10
+#define PARTIDXMAGIC "GHIX"
+#define PARTIDXHDRSZ 8
+#define PARTIDXENTSZ 16
+#define PARTIDXBIN 0
+#define PARTIDXGHZ 1
+
+// Structures
+typedef struct partlog
+{
+    binlog_s log;
+    int idxfd;
+    int64_t dayend;
+    int64_t latest;
+    unsigned batches;
+    char day[PARTDAYSZ];
+    pthread_t worker;
+    int running;
+    pthread_mutex_t lock;
+    pthread_cond_t wake;
+    char queue[PARTQUEUE][PARTDAYSZ];
+    int qhead;
+    int qcount;
+    int stop;
+} partlog_s;
+
+//@cond INTERNAL
+int GhPartOpen(partlog_s * pl);
+int GhPartAppend(partlog_s * pl, const reading_s * rd);
+int GhPartClose(partlog_s * pl);
+int GhPartCompress(const char * day);
+long GhPartRead(time_t from, time_t to, reading_s * out, long max);
+//@endcond
+#endif
@@ -0,0 +1,311 @@
+/** @brief Fixed-size circular on-disk log
+*   @file ghring.c
+*   The file is preallocated once to one header page plus npages data
+*   pages and never grows. Records are collected in a page buffer and
+*   written as whole, page-aligned 4 KiB pages. When the ring is full the
+*   oldest page is overwritten in place. The header page holds the head
+*   (page being filled) and tail (oldest page) indices.
+*
+*   Data page layout: "GHRP", u32 sequence, u16 record count, 6 reserved
+*   bytes, then RINGPERPAGE LOGRECSZ records, all little-endian.
+*/
+
+#define _GNU_SOURCE //O_DIRECT, must occur before library includes
+#include "ghring.h"
+#include "ghlog.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+/**
+ * @brief Writes one page at a page-aligned offset
+ * @param fd ring file
+ * @param buf page
+ * @param index page index, 0 is the header page
+ * @return int 1 on success, 0 on a write error
+ */
+static int GhRingPutPage(int fd, const uint8_t * buf, uint32_t index)
+{
+    ssize_t n;
+
+    do
+    {
+        n = pwrite(fd, buf, RINGPAGESZ, (off_t) index * RINGPAGESZ);
+    } while(n < 0 && errno == EINTR);
+    if(n != RINGPAGESZ)
+    {
+        fprintf(stderr,"\nRing log write failed\n");
+        return 0;
+    }
+    return 1;
+}
+
+/**
+ * @brief Stores the ring geometry and head/tail indices in the header page
+ * @param rl open ring
+ * @return int 1 on success, 0 on a write error
+ */
+static int GhRingPutHeader(ringlog_s * rl)
+{
+    memcpy(rl->hdr, RINGMAGIC, 4);
+    rl->hdr[4] = RINGVERSION;
+    GhPutLe32(rl->hdr + 8, RINGPAGESZ);
+    GhPutLe32(rl->hdr + 12, rl->npages);
+    GhPutLe32(rl->hdr + 16, LOGRECSZ);
+    GhPutLe32(rl->hdr + 20, rl->head);
+    GhPutLe32(rl->hdr + 24, rl->tail);
+    GhPutLe32(rl->hdr + 28, rl->seq);
+    return GhRingPutPage(rl->fd, rl->hdr, 0);
+}
+
+/**
+ * @brief Moves the head on to the next page once the current one is on disk
+ * @param rl open ring whose head page is full and written
+ * @return int 1 on success, 0 on a write error
+ */
+static int GhRingAdvance(ringlog_s * rl)
+{
+    rl->count = 0;
+    rl->seq++;
+    rl->head = (rl->head + 1) % rl->npages;
+    if(rl->head == rl->tail)
+    {
+        // Full, the oldest page is overwritten next
+        rl->tail = (rl->tail + 1) % rl->npages;
+    }
+    memset(rl->page, 0, RINGPAGESZ);
+    return GhRingPutHeader(rl);
+}
+
+/**
+ * @brief Opens the ring, creating and preallocating it on first use
+ * @version CENG153, serial: 85048a62
+ * @author Devansh Patel
+ * @since 2026-10-19
+ * @param rl ring state to initialise
+ * @param fname ring file name
+ * @param npages number of data pages for a new ring, ignored for an existing one
+ * @return int 1 if the ring is ready, 0 otherwise
+ */
+int GhRingOpen(ringlog_s * rl, const char * fname, uint32_t npages)
+{
+    off_t size;
+
+    rl->fd = -1;
+    rl->count = 0;
+    rl->page = NULL;
+    rl->hdr = NULL;
+    if(posix_memalign((void **) &rl->page, RINGPAGESZ, RINGPAGESZ) != 0 ||
+       posix_memalign((void **) &rl->hdr, RINGPAGESZ, RINGPAGESZ) != 0)
+    {
+        fprintf(stderr,"\nCannot allocate memory\n");
+        free(rl->page);
+        return 0;
+    }
+    memset(rl->page, 0, RINGPAGESZ);
+    memset(rl->hdr, 0, RINGPAGESZ);
+
+    // Bypass the page cache where the filesystem allows it, every write is a whole aligned page anyway
+    rl->fd = open(fname, O_RDWR | O_CREAT | O_DIRECT, 0644);
+    if(rl->fd < 0 && errno == EINVAL)
+    {
+        rl->fd = open(fname, O_RDWR | O_CREAT, 0644);
+    }
+    if(rl->fd < 0)
+    {
+        fprintf(stderr,"\nCan't open ring log %s\n", fname);
+        GhRingClose(rl);
+        return 0;
+    }
+
+    size = lseek(rl->fd, 0, SEEK_END);
+    if(size == 0)
+    {
+        rl->npages = npages;
+        rl->head = 0;
+        rl->tail = 0;
+        rl->seq = 1;
+        if(posix_fallocate(rl->fd, 0, (off_t) (npages + 1) * RINGPAGESZ) != 0)
+        {
+            fprintf(stderr,"\nCan't preallocate ring log %s\n", fname);
+            GhRingClose(rl);
+            return 0;
+        }
+        return GhRingPutHeader(rl);
+    }
+
+    if(pread(rl->fd, rl->hdr, RINGPAGESZ, 0) != RINGPAGESZ || memcmp(rl->hdr, RINGMAGIC, 4) != 0 ||
+       rl->hdr[4] != RINGVERSION || GhGetLe32(rl->hdr + 8) != RINGPAGESZ || GhGetLe32(rl->hdr + 16) != LOGRECSZ)
+    {
+        fprintf(stderr,"\n%s is not a version %d ring log\n", fname, RINGVERSION);
+        GhRingClose(rl);
+        return 0;
+    }
+    rl->npages = GhGetLe32(rl->hdr + 12);
+    rl->head = GhGetLe32(rl->hdr + 20);
+    rl->tail = GhGetLe32(rl->hdr + 24);
+    rl->seq = GhGetLe32(rl->hdr + 28);
+    if(rl->npages < 2 || rl->head >= rl->npages || rl->tail >= rl->npages ||
+       size < (off_t) (rl->npages + 1) * RINGPAGESZ)
+    {
+        fprintf(stderr,"\nRing log %s header is damaged\n", fname);
+        GhRingClose(rl);
+        return 0;
+    }
+
+    // Carry on filling a head page that was flushed before the last shutdown
+    if(pread(rl->fd, rl->page, RINGPAGESZ, (off_t) (rl->head + 1) * RINGPAGESZ) == RINGPAGESZ &&
+       memcmp(rl->page, RINGPAGEMAGIC, 4) == 0 && GhGetLe32(rl->page + 4) == rl->seq)
+    {
+        rl->count = rl->page[8] | rl->page[9] << 8;
+        if(rl->count >= RINGPERPAGE)
+        {
+            // Power was lost between writing a full page and the header
+            return GhRingAdvance(rl);
+        }
+    }
+    else
+    {
+        memset(rl->page, 0, RINGPAGESZ);
+    }
+    return 1;
+}
+
+/**
+ * @brief Writes the page being filled to its slot without advancing the head
+ * @version CENG153, serial: 85048a62
+ * @author Devansh Patel
+ * @since 2026-10-19
+ * @param rl open ring
+ * @return int 1 on success, 0 on a write error
+ */
+int GhRingFlush(ringlog_s * rl)
+{
+    if(rl->count == 0)
+    {
+        return 1;
+    }
+    memcpy(rl->page, RINGPAGEMAGIC, 4);
+    GhPutLe32(rl->page + 4, rl->seq);
+    rl->page[8] = rl->count;
+    rl->page[9] = rl->count >> 8;
+    return GhRingPutPage(rl->fd, rl->page, rl->head + 1);
+}
+
+/**
+ * @brief Adds one reading, writing out the page and advancing the ring when it fills
+ * @version CENG153, serial: 85048a62
+ * @author Devansh Patel
+ * @since 2026-10-19
+ * @param rl open ring
+ * @param rd reading to log
+ * @return int 1 on success, 0 on a write error
+ */
+int GhRingAppend(ringlog_s * rl, const reading_s * rd)
+{
+    GhPackRecord(rl->page + RINGPAGEHDRSZ + rl->count * LOGRECSZ, rd);
+    rl->count++;
+    if(rl->count < RINGPERPAGE)
+    {
+        return 1;
+    }
+
+    return GhRingFlush(rl) && GhRingAdvance(rl);
+}
+
+/**
+ * @brief Flushes the partial page and closes the ring
+ * @version CENG153, serial: 85048a62
+ * @author Devansh Patel
+ * @since 2026-10-19
+ * @param rl ring
+ * @return int 1 on success, 0 if the partial page could not be written
+ */
+int GhRingClose(ringlog_s * rl)
+{
+    int ok = 1;
+
+    if(rl->fd >= 0 && rl->page != NULL)
+    {
+        ok = GhRingFlush(rl);
+    }
+    if(rl->fd >= 0)
+    {
+        close(rl->fd);
+    }
+    free(rl->page);
+    free(rl->hdr);
+    rl->fd = -1;
+    rl->page = NULL;
+    rl->hdr = NULL;
+    return ok;
+}
+
+/**
+ * @brief Reads the readings in [from, to) from a ring, oldest first
+ * @version CENG153, serial: 85048a62
+ * @author Devansh Patel
+ * @since 2026-10-19
+ * @param fname ring file name
+ * @param from earliest time
+ * @param to end of the range
+ * @param out readings read
+ * @param max capacity of out
+ * @return long number of readings, -1 if the ring cannot be read
+ */
+long GhRingRead(const char * fname, time_t from, time_t to, reading_s * out, long max)
+{
+    uint8_t hdr[32];
+    uint8_t page[RINGPAGESZ];
+    uint32_t npages, head, tail, seq, i;
+    reading_s rd;
+    long n = 0;
+    int fd, count, r;
+
+    fd = open(fname, O_RDONLY);
+    if(fd < 0)
+    {
+        return -1;
+    }
+    if(pread(fd, hdr, sizeof(hdr), 0) != sizeof(hdr) || memcmp(hdr, RINGMAGIC, 4) != 0 || hdr[4] != RINGVERSION)
+    {
+        close(fd);
+        return -1;
+    }
+    npages = GhGetLe32(hdr + 12);
+    head = GhGetLe32(hdr + 20);
+    tail = GhGetLe32(hdr + 24);
+    seq = GhGetLe32(hdr + 28);
+
+    for(i = tail; n < max; i = (i + 1) % npages)
+    {
+        if(pread(fd, page, RINGPAGESZ, (off_t) (i + 1) * RINGPAGESZ) != RINGPAGESZ || memcmp(page, RINGPAGEMAGIC, 4) != 0)
+        {
+            if(i == head)
+            {
+                break;
+            }
+            continue;
+        }
+        // The head page only counts if it was flushed after the header was last written
+        if(i == head && GhGetLe32(page + 4) != seq)
+        {
+            break;
+        }
+        count = page[8] | page[9] << 8;
+        for(r = 0; r < count && r < RINGPERPAGE && n < max; r++)
+        {
+            GhUnpackRecord(page + RINGPAGEHDRSZ + r * LOGRECSZ, &rd);
+            if(rd.rtime >= from && rd.rtime < to)
+            {
+                out[n++] = rd;
+            }
+        }
+        if(i == head)
+        {
+            break;
+        }
+    }
+    close(fd);
+    return n;
+}
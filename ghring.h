@@ -0,0 +1,44 @@
+/** @brief Circular on-disk log constants, structures, function prototypes
+*   @file ghring.h
+*/
+
+#ifndef GHRING_H
+#define GHRING_H
+
+// Includes
+#include <stdint.h>
+#include <stddef.h>
+#include "ghcontrol.h"
+#include "ghlog.h"
+
+// Constants
+#define RINGFILE "ghring.dat"
+#define RINGMAGIC "GHRG"
+#define RINGPAGEMAGIC "GHRP"
+#define RINGVERSION 1
+#define RINGPAGESZ 4096
+#define RINGPAGES 8192
+#define RINGPAGEHDRSZ 16
+#define RINGPERPAGE ((RINGPAGESZ - RINGPAGEHDRSZ) / LOGRECSZ)
+
+// Structures
+typedef struct ringlog
+{
+    int fd;
+    uint32_t npages;
+    uint32_t head;
+    uint32_t tail;
+    uint32_t seq;
+    int count;
+    uint8_t * page;
+    uint8_t * hdr;
+} ringlog_s;
+
+//@cond INTERNAL
+int GhRingOpen(ringlog_s * rl, const char * fname, uint32_t npages);
+int GhRingAppend(ringlog_s * rl, const reading_s * rd);
+int GhRingFlush(ringlog_s * rl);
+int GhRingClose(ringlog_s * rl);
+long GhRingRead(const char * fname, time_t from, time_t to, reading_s * out, long max);
+//@endcond
+#endif
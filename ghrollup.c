@@ -0,0 +1,261 @@
+/** @brief 1-minute, 1-hour and 1-day rollups maintained on ingest
+*   @file ghrollup.c
+*   Each tier keeps running min/max/sum/count per channel for the period
+*   in progress and appends one fixed-size record to its own file when
+*   the period closes. Periods are aligned to local time, so a day tier
+*   record covers midnight to midnight.
+*/
+
+#include "ghrollup.h"
+#include "ghlog.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+/**
+ * @brief Starts a new period for a tier
+ * @param tr tier
+ * @param t time of the sample opening the period
+ * @return void
+ */
+static void GhRollupStart(rolltier_s * tr, int64_t t)
+{
+    struct tm lt;
+    time_t tt = (time_t) t;
+    int64_t local;
+    int i;
+
+    localtime_r(&tt, &lt);
+    local = t + lt.tm_gmtoff;
+    tr->acc.start = t - (((local % tr->period) + tr->period) % tr->period);
+    tr->end = tr->acc.start + tr->period;
+    tr->acc.count = 0;
+    for(i = 0; i < ROLLCHANNELS; i++)
+    {
+        tr->acc.sum[i] = 0.0;
+    }
+}
+
+/**
+ * @brief Appends the closed period of a tier to its file
+ * @param tr tier with at least one sample
+ * @return int 1 on success, 0 on a write error
+ */
+static int GhRollupWrite(rolltier_s * tr)
+{
+    uint8_t rec[ROLLRECSZ];
+    uint8_t * p = rec + 12;
+    uint64_t d;
+    uint32_t f;
+    int i;
+
+    GhPutLe64(rec, (uint64_t) tr->acc.start);
+    GhPutLe32(rec + 8, tr->acc.count);
+    for(i = 0; i < ROLLCHANNELS; i++, p += 16)
+    {
+        memcpy(&f, &tr->acc.min[i], 4);
+        GhPutLe32(p, f);
+        memcpy(&f, &tr->acc.max[i], 4);
+        GhPutLe32(p + 4, f);
+        memcpy(&d, &tr->acc.sum[i], 8);
+        GhPutLe64(p + 8, d);
+    }
+    while(write(tr->fd, rec, sizeof(rec)) != sizeof(rec))
+    {
+        if(errno != EINTR)
+        {
+            fprintf(stderr,"\nRollup write failed\n");
+            return 0;
+        }
+    }
+    return 1;
+}
+
+/**
+ * @brief Opens the rollup tier files
+ * @version CENG153, serial: 85048a62
+ * @author Devansh Patel
+ * @since 2026-10-19
+ * @param ru rollup state to initialise
+ * @return int 1 if every tier file is open, 0 otherwise
+ */
+int GhRollupInit(rollup_s * ru)
+{
+    static const char * fnames[ROLLTIERS] = { ROLLMINFILE, ROLLHOURFILE, ROLLDAYFILE };
+    static const int64_t periods[ROLLTIERS] = { ROLLMINUTE, ROLLHOUR, ROLLDAY };
+    int i, ok = 1;
+
+    for(i = 0; i < ROLLTIERS; i++)
+    {
+        ru->tier[i].period = periods[i];
+        ru->tier[i].end = 0;
+        ru->tier[i].acc.count = 0;
+        ru->tier[i].fd = open(fnames[i], O_WRONLY | O_CREAT | O_APPEND, 0644);
+        if(ru->tier[i].fd < 0)
+        {
+            fprintf(stderr,"\nCan't open rollup file %s\n", fnames[i]);
+            ok = 0;
+        }
+    }
+    return ok;
+}
+
+/**
+ * @brief Folds one reading into every tier, writing out tiers whose period closed
+ * @version CENG153, serial: 85048a62
+ * @author Devansh Patel
+ * @since 2026-10-19
+ * @param ru rollup state
+ * @param rd new reading
+ * @return int number of periods closed and written
+ */
+int GhRollupUpdate(rollup_s * ru, reading_s rd)
+{
+    float v[ROLLCHANNELS] = { rd.temperature, rd.humidity, rd.pressure };
+    int64_t t = rd.rtime;
+    rolltier_s * tr;
+    int i, c, closed = 0;
+
+    for(i = 0; i < ROLLTIERS; i++)
+    {
+        tr = &ru->tier[i];
+        if(t >= tr->end || t < tr->acc.start)
+        {
+            if(tr->acc.count > 0 && tr->fd >= 0)
+            {
+                closed += GhRollupWrite(tr);
+            }
+            GhRollupStart(tr, t);
+        }
+        if(tr->acc.count == 0)
+        {
+            for(c = 0; c < ROLLCHANNELS; c++)
+            {
+                tr->acc.min[c] = v[c];
+                tr->acc.max[c] = v[c];
+            }
+        }
+        for(c = 0; c < ROLLCHANNELS; c++)
+        {
+            tr->acc.min[c] = v[c] < tr->acc.min[c] ? v[c] : tr->acc.min[c];
+            tr->acc.max[c] = v[c] > tr->acc.max[c] ? v[c] : tr->acc.max[c];
+            tr->acc.sum[c] += v[c];
+        }
+        tr->acc.count++;
+    }
+    return closed;
+}
+
+/**
+ * @brief Writes out the periods in progress, e.g. before shutting down
+ * @version CENG153, serial: 85048a62
+ * @author Devansh Patel
+ * @since 2026-10-19
+ * @param ru rollup state
+ * @return int 1 on success, 0 on a write error
+ */
+int GhRollupFlush(rollup_s * ru)
+{
+    int i, ok = 1;
+
+    for(i = 0; i < ROLLTIERS; i++)
+    {
+        if(ru->tier[i].acc.count > 0 && ru->tier[i].fd >= 0)
+        {
+            ok &= GhRollupWrite(&ru->tier[i]);
+            ru->tier[i].acc.count = 0;
+            ru->tier[i].end = 0;
+        }
+    }
+    return ok;
+}
+
+/**
+ * @brief Reads the rollup records of one tier file whose period starts in [from, to)
+ * @version CENG153, serial: 85048a62
+ * @author Devansh Patel
+ * @since 2026-10-19
+ * @param fname tier file, e.g. ROLLHOURFILE
+ * @param from earliest period start
+ * @param to end of the range
+ * @param out records read; records split by a restart are merged
+ * @param max capacity of out
+ * @return int number of records, -1 if the file cannot be read
+ */
+int GhRollupRead(const char * fname, int64_t from, int64_t to, rollrec_s * out, int max)
+{
+    uint8_t rec[ROLLRECSZ];
+    uint8_t * p;
+    uint64_t d;
+    uint32_t f;
+    off_t size, lo, hi, mid;
+    rollrec_s r;
+    int fd, n = 0, c;
+
+    fd = open(fname, O_RDONLY);
+    if(fd < 0)
+    {
+        return -1;
+    }
+    size = lseek(fd, 0, SEEK_END) / ROLLRECSZ;
+
+    // Records are appended in time order, so binary search for the first one >= from
+    lo = 0;
+    hi = size;
+    while(lo < hi)
+    {
+        mid = lo + (hi - lo) / 2;
+        if(pread(fd, rec, 8, mid * ROLLRECSZ) != 8)
+        {
+            break;
+        }
+        if((int64_t) GhGetLe64(rec) < from)
+        {
+            lo = mid + 1;
+        }
+        else
+        {
+            hi = mid;
+        }
+    }
+
+    for(; lo < size && pread(fd, rec, ROLLRECSZ, lo * ROLLRECSZ) == ROLLRECSZ; lo++)
+    {
+        r.start = (int64_t) GhGetLe64(rec);
+        if(r.start >= to)
+        {
+            break;
+        }
+        r.count = GhGetLe32(rec + 8);
+        for(c = 0, p = rec + 12; c < ROLLCHANNELS; c++, p += 16)
+        {
+            f = GhGetLe32(p);
+            memcpy(&r.min[c], &f, 4);
+            f = GhGetLe32(p + 4);
+            memcpy(&r.max[c], &f, 4);
+            d = GhGetLe64(p + 8);
+            memcpy(&r.sum[c], &d, 8);
+        }
+
+        if(n > 0 && out[n - 1].start == r.start)
+        {
+            for(c = 0; c < ROLLCHANNELS; c++)
+            {
+                out[n - 1].min[c] = r.min[c] < out[n - 1].min[c] ? r.min[c] : out[n - 1].min[c];
+                out[n - 1].max[c] = r.max[c] > out[n - 1].max[c] ? r.max[c] : out[n - 1].max[c];
+                out[n - 1].sum[c] += r.sum[c];
+            }
+            out[n - 1].count += r.count;
+        }
+        else if(n < max)
+        {
+            out[n++] = r;
+        }
+        else
+        {
+            break;
+        }
+    }
+    close(fd);
+    return n;
+}
@@ -0,0 +1,52 @@
+/** @brief Rollup tier constants, structures, function prototypes
+*   @file ghrollup.h
+*/
+
+#ifndef GHROLLUP_H
+#define GHROLLUP_H
+
+// Includes
+#include <stdint.h>
+#include "ghcontrol.h"
+
+// Constants
+#define ROLLTIERS 3
+#define ROLLCHANNELS 3
+#define ROLLRECSZ (12 + ROLLCHANNELS * 16)
+#define ROLLMINUTE 60
+#define ROLLHOUR 3600
+#define ROLLDAY 86400
+#define ROLLMINFILE "ghroll1m.dat"
+#define ROLLHOURFILE "ghroll1h.dat"
+#define ROLLDAYFILE "ghroll1d.dat"
+
+// Structures
+typedef struct rollrec
+{
+    int64_t start;
+    uint32_t count;
+    float min[ROLLCHANNELS];
+    float max[ROLLCHANNELS];
+    double sum[ROLLCHANNELS];
+} rollrec_s;
+
+typedef struct rolltier
+{
+    int fd;
+    int64_t period;
+    int64_t end;
+    rollrec_s acc;
+} rolltier_s;
+
+typedef struct rollup
+{
+    rolltier_s tier[ROLLTIERS];
+} rollup_s;
+
+//@cond INTERNAL
+int GhRollupInit(rollup_s * ru);
+int GhRollupUpdate(rollup_s * ru, reading_s rd);
+int GhRollupFlush(rollup_s * ru);
+int GhRollupRead(const char * fname, int64_t from, int64_t to, rollrec_s * out, int max);
+//@endcond
+#endif
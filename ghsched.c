@@ -0,0 +1,271 @@
+/** @brief Time-of-day setpoint schedules
+*   @file ghsched.c
+*   A schedule file lists the points of the week where the targets change:
+*
+*       # days   time   temp  humid  [ramp minutes]
+*       daily    06:00  24.0  60     ramp 30
+*       daily    20:00  18.0  70     ramp 60
+*       sat,sun  08:00  22.0  60
+*
+*   Days are daily, a day name (sun to sat), a range such as mon-fri, or a
+*   comma separated list of those. A point holds until the next one. With
+*   a ramp the targets move linearly from the previous point's values and
+*   arrive after the given number of minutes. If two points fall on the
+*   same minute the later line wins.
+*
+*   The points are compiled once, at load time, into one setpoint per
+*   minute of the week, so looking up the current target is a single index.
+*/
+
+#include "ghsched.h"
+
+static const char schednames[7][4] = {"sun","mon","tue","wed","thu","fri","sat"};
+
+/**
+ * @brief Orders schedule points by minute of the week, then by line
+ * @param a first point
+ * @param b second point
+ * @return int negative, zero or positive as for qsort
+ */
+static int GhSchedOrder(const void * a, const void * b)
+{
+    const schedpoint_s * pa = a;
+    const schedpoint_s * pb = b;
+
+    if(pa->minute != pb->minute)
+    {
+        return pa->minute - pb->minute;
+    }
+    return pa->line - pb->line;
+}
+
+/**
+ * @brief Looks up a three letter day name
+ * @param s day name, need not be terminated after three letters
+ * @return int day of the week with sunday 0, -1 if unknown
+ */
+static int GhSchedDay(const char * s)
+{
+    int d;
+
+    for(d = 0; d < 7; d++)
+    {
+        if(strncmp(s, schednames[d], 3) == 0)
+        {
+            return d;
+        }
+    }
+    return -1;
+}
+
+/**
+ * @brief Parses a day specification into a bit per day
+ * @param spec daily, a day, a range or a comma separated list of those
+ * @return int day mask with bit 0 sunday, 0 if spec is invalid
+ */
+static int GhSchedDays(const char * spec)
+{
+    int mask = 0, first, last;
+    const char * p = spec;
+
+    if(strcmp(spec, "daily") == 0)
+    {
+        return 0x7f;
+    }
+    while(1)
+    {
+        first = GhSchedDay(p);
+        if(first < 0)
+        {
+            return 0;
+        }
+        p += 3;
+        last = first;
+        if(*p == '-')
+        {
+            last = GhSchedDay(p + 1);
+            if(last < 0)
+            {
+                return 0;
+            }
+            p += 4;
+        }
+        // A range may wrap past saturday, e.g. fri-mon
+        for(mask |= 1 << first; first != last; first = (first + 1) % 7, mask |= 1 << first);
+        if(*p == '\0')
+        {
+            return mask;
+        }
+        if(*p++ != ',')
+        {
+            return 0;
+        }
+    }
+}
+
+/**
+ * @brief Fills a minute-of-week table from schedule points
+ * @version CENG153, serial: 85048a62
+ * @author Devansh Patel
+ * @since 2026-10-19
+ * @param pts schedule points, sorted in place
+ * @param n number of points, at least 1
+ * @param sched table to fill
+ * @return void
+ */
+void GhScheduleCompile(schedpoint_s * pts, int n, schedule_s * sched)
+{
+    const schedpoint_s * cur;
+    const schedpoint_s * prev;
+    int i, k, m, len, d;
+
+    qsort(pts, n, sizeof(schedpoint_s), GhSchedOrder);
+    // Keep only the last line given for each minute
+    for(i = 0, k = 0; i < n; i++)
+    {
+        if(k > 0 && pts[k - 1].minute == pts[i].minute)
+        {
+            k--;
+        }
+        pts[k++] = pts[i];
+    }
+    n = k;
+
+    for(i = 0; i < n; i++)
+    {
+        cur = &pts[i];
+        prev = &pts[(i + n - 1) % n];
+        len = (i + 1 < n) ? pts[i + 1].minute - cur->minute : pts[0].minute + SCHEDMINUTES - cur->minute;
+        for(d = 0; d < len; d++)
+        {
+            m = (cur->minute + d) % SCHEDMINUTES;
+            if(d < cur->ramp)
+            {
+                sched->lut[m].temperature = prev->temperature + (cur->temperature - prev->temperature) * d / cur->ramp;
+                sched->lut[m].humidity = prev->humidity + (cur->humidity - prev->humidity) * d / cur->ramp;
+            }
+            else
+            {
+                sched->lut[m].temperature = cur->temperature;
+                sched->lut[m].humidity = cur->humidity;
+            }
+        }
+    }
+}
+
+/**
+ * @brief Reads, validates and compiles a schedule file
+ * @version CENG153, serial: 85048a62
+ * @author Devansh Patel
+ * @since 2026-10-19
+ * @param fname schedule file name
+ * @param sched new compiled schedule, NULL if the file does not exist or has no points
+ * @return int 1 if sched is valid, 0 if the file has errors
+ */
+int GhScheduleLoad(const char * fname, schedule_s ** sched)
+{
+    char line[SCHEDLINESZ], days[SCHEDDAYSSZ], word[SCHEDDAYSSZ], extra;
+    schedpoint_s * pts;
+    schedpoint_s pt;
+    int lineno = 0, n = 0, ok = 1, hh, mm, mask, d, f;
+    FILE *fp;
+
+    *sched = NULL;
+    fp = fopen(fname,"r");
+    if(fp == NULL)
+    {
+        return 1;
+    }
+    pts = malloc(SCHEDPOINTS * sizeof(schedpoint_s));
+    if(pts == NULL)
+    {
+        fprintf(stderr,"\nCannot allocate memory\n");
+        fclose(fp);
+        return 0;
+    }
+
+    while(fgets(line, sizeof(line), fp) != NULL)
+    {
+        lineno++;
+        line[strcspn(line, "#")] = '\0';
+        if(sscanf(line, " %c", &extra) != 1)
+        {
+            continue;
+        }
+        pt.ramp = 0;
+        pt.line = lineno;
+        f = sscanf(line, " %31s %d:%d %f %f %31s %d %c", days, &hh, &mm, &pt.temperature, &pt.humidity, word, &pt.ramp, &extra);
+        mask = GhSchedDays(days);
+        if((f != 5 && (f != 7 || strcmp(word, "ramp") != 0)) || mask == 0 ||
+           hh < 0 || hh > 23 || mm < 0 || mm > 59 || pt.ramp < 0 || pt.ramp > SCHEDDAY ||
+           !(pt.temperature >= LSTEMP && pt.temperature <= USTEMP) ||
+           !(pt.humidity >= LSHUMID && pt.humidity <= USHUMID))
+        {
+            fprintf(stderr,"\n%s line %d: expected days HH:MM temperature humidity [ramp minutes]\n", fname, lineno);
+            ok = 0;
+            continue;
+        }
+        for(d = 0; d < 7; d++)
+        {
+            if(!(mask & 1 << d))
+            {
+                continue;
+            }
+            if(n == SCHEDPOINTS)
+            {
+                fprintf(stderr,"\n%s line %d: more than %d points\n", fname, lineno, SCHEDPOINTS);
+                ok = 0;
+                break;
+            }
+            pt.minute = d * SCHEDDAY + hh * 60 + mm;
+            pts[n++] = pt;
+        }
+    }
+    fclose(fp);
+
+    if(ok && n > 0)
+    {
+        *sched = malloc(sizeof(schedule_s));
+        if(*sched == NULL)
+        {
+            fprintf(stderr,"\nCannot allocate memory\n");
+            ok = 0;
+        }
+        else
+        {
+            GhScheduleCompile(pts, n, *sched);
+        }
+    }
+    free(pts);
+    return ok;
+}
+
+/**
+ * @brief Minute of the local week a time falls in
+ * @version CENG153, serial: 85048a62
+ * @author Devansh Patel
+ * @since 2026-10-19
+ * @param t time
+ * @return int 0 for sunday 00:00 to SCHEDMINUTES - 1 for saturday 23:59
+ */
+int GhScheduleMinute(time_t t)
+{
+    struct tm lt;
+
+    localtime_r(&t, &lt);
+    return lt.tm_wday * SCHEDDAY + lt.tm_hour * 60 + lt.tm_min;
+}
+
+/**
+ * @brief Scheduled targets at a given time
+ * @version CENG153, serial: 85048a62
+ * @author Devansh Patel
+ * @since 2026-10-19
+ * @param sched compiled schedule
+ * @param t time
+ * @return setpoint_s targets in force at t
+ */
+setpoint_s GhScheduleTarget(const schedule_s * sched, time_t t)
+{
+    return sched->lut[GhScheduleMinute(t)];
+}
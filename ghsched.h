@@ -0,0 +1,40 @@
+/** @brief Setpoint schedule constants, structures, function prototypes
+*   @file ghsched.h
+*/
+
+#ifndef GHSCHED_H
+#define GHSCHED_H
+
+// Includes
+#include "ghcontrol.h"
+
+// Constants
+#define SCHEDFILE "ghschedule.conf"
+#define SCHEDDAY 1440
+#define SCHEDMINUTES (7 * SCHEDDAY)
+#define SCHEDPOINTS 256
+#define SCHEDLINESZ 128
+#define SCHEDDAYSSZ 32
+
+// Structures
+typedef struct schedpoint
+{
+    int minute;
+    int ramp;
+    int line;
+    float temperature;
+    float humidity;
+} schedpoint_s;
+
+typedef struct schedule
+{
+    setpoint_s lut[SCHEDMINUTES];
+} schedule_s;
+
+//@cond INTERNAL
+int GhScheduleLoad(const char * fname, schedule_s ** sched);
+void GhScheduleCompile(schedpoint_s * pts, int n, schedule_s * sched);
+int GhScheduleMinute(time_t t);
+setpoint_s GhScheduleTarget(const schedule_s * sched, time_t t);
+//@endcond
+#endif
@@ -0,0 +1,159 @@
+/** @brief Shared-memory state segment
+*   @file ghshm.c
+*   The controller publishes its latest readings, setpoints, controls and
+*   alarm bits in the POSIX shared-memory object SHMNAME, so dashboards and
+*   exporters on the same machine can read them without scraping output.
+*
+*   The segment is guarded by a sequence lock. The writer makes the
+*   sequence odd, updates the state, and makes it even again. A reader
+*   copies the state between two loads of the sequence and keeps the copy
+*   only if both loads are the same even value. Readers never write to the
+*   segment, so any number of them cannot slow down the control loop.
+*/
+
+#include "ghshm.h"
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+/**
+ * @brief Creates or reopens the state segment for publishing
+ * @version CENG153, serial: 85048a62
+ * @author Devansh Patel
+ * @since 2026-10-19
+ * @return shmseg_s* mapped segment, NULL if shared memory is unavailable
+ */
+shmseg_s * GhShmOpen(void)
+{
+    shmseg_s * seg;
+    int fd;
+
+    fd = shm_open(SHMNAME, O_RDWR | O_CREAT, 0644);
+    if(fd < 0 || ftruncate(fd, sizeof(shmseg_s)) != 0)
+    {
+        fprintf(stderr,"\nCan't create shared memory %s\n", SHMNAME);
+        if(fd >= 0)
+        {
+            close(fd);
+        }
+        return NULL;
+    }
+    seg = mmap(NULL, sizeof(shmseg_s), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if(seg == MAP_FAILED)
+    {
+        fprintf(stderr,"\nCan't map shared memory %s\n", SHMNAME);
+        return NULL;
+    }
+
+    // A sequence left odd by a controller that died mid-update is made even again
+    __atomic_store_n(&seg->seq, (__atomic_load_n(&seg->seq, __ATOMIC_RELAXED) + 1) & ~1u, __ATOMIC_RELEASE);
+    seg->version = SHMVERSION;
+    seg->size = sizeof(shmseg_s);
+    seg->pid = getpid();
+    memcpy(seg->magic, SHMMAGIC, 4);
+    return seg;
+}
+
+/**
+ * @brief Publishes the state of one control cycle
+ * @version CENG153, serial: 85048a62
+ * @author Devansh Patel
+ * @since 2026-10-19
+ * @param seg segment from GhShmOpen, NULL to do nothing
+ * @param st state to publish
+ * @return void
+ */
+void GhShmPublish(shmseg_s * seg, const ghstate_s * st)
+{
+    uint32_t seq;
+
+    if(seg == NULL)
+    {
+        return;
+    }
+    seq = __atomic_load_n(&seg->seq, __ATOMIC_RELAXED);
+    __atomic_store_n(&seg->seq, seq + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    memcpy(&seg->state, st, sizeof(ghstate_s));
+    __atomic_store_n(&seg->seq, seq + 2, __ATOMIC_RELEASE);
+}
+
+/**
+ * @brief Unmaps the segment, leaving it in place for readers
+ * @version CENG153, serial: 85048a62
+ * @author Devansh Patel
+ * @since 2026-10-19
+ * @param seg segment from GhShmOpen or GhShmAttach
+ * @return void
+ */
+void GhShmClose(shmseg_s * seg)
+{
+    if(seg != NULL)
+    {
+        munmap(seg, sizeof(shmseg_s));
+    }
+}
+
+/**
+ * @brief Maps the state segment read-only, for reader processes
+ * @version CENG153, serial: 85048a62
+ * @author Devansh Patel
+ * @since 2026-10-19
+ * @return const shmseg_s* mapped segment, NULL if the controller has not created it or it is another version
+ */
+const shmseg_s * GhShmAttach(void)
+{
+    shmseg_s * seg;
+    int fd;
+
+    fd = shm_open(SHMNAME, O_RDONLY, 0);
+    if(fd < 0)
+    {
+        return NULL;
+    }
+    seg = mmap(NULL, sizeof(shmseg_s), PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if(seg == MAP_FAILED)
+    {
+        return NULL;
+    }
+    if(memcmp(seg->magic, SHMMAGIC, 4) != 0 || seg->version != SHMVERSION || seg->size != sizeof(shmseg_s))
+    {
+        munmap(seg, sizeof(shmseg_s));
+        return NULL;
+    }
+    return seg;
+}
+
+/**
+ * @brief Takes a consistent copy of the published state
+ * @version CENG153, serial: 85048a62
+ * @author Devansh Patel
+ * @since 2026-10-19
+ * @param seg segment from GhShmAttach
+ * @param st copy of the state
+ * @return int 1 on success, 0 if no consistent copy was seen in SHMRETRIES tries
+ */
+int GhShmSnapshot(const shmseg_s * seg, ghstate_s * st)
+{
+    uint32_t s1, s2;
+    int i;
+
+    for(i = 0; i < SHMRETRIES; i++)
+    {
+        s1 = __atomic_load_n(&seg->seq, __ATOMIC_ACQUIRE);
+        if(s1 & 1)
+        {
+            continue;
+        }
+        memcpy(st, (const void *) &seg->state, sizeof(ghstate_s));
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        s2 = __atomic_load_n(&seg->seq, __ATOMIC_RELAXED);
+        if(s1 == s2)
+        {
+            return 1;
+        }
+    }
+    return 0;
+}
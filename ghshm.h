@@ -0,0 +1,45 @@
+/** @brief Shared-memory state segment constants, structures, function prototypes
+*   @file ghshm.h
+*/
+
+#ifndef GHSHM_H
+#define GHSHM_H
+
+// Includes
+#include <stdint.h>
+#include "ghcontrol.h"
+
+// Constants
+#define SHMNAME "/ghcontrol"
+#define SHMMAGIC "GHSM"
+#define SHMVERSION 1
+#define SHMRETRIES 1000
+
+// Structures
+typedef struct ghstate
+{
+    reading_s readings;
+    setpoint_s setpoints;
+    control_s controls;
+    uint32_t alarms;
+    uint32_t cycles;
+} ghstate_s;
+
+typedef struct shmseg
+{
+    char magic[4];
+    uint16_t version;
+    uint16_t size;
+    uint32_t seq;
+    uint32_t pid;
+    ghstate_s state;
+} shmseg_s;
+
+//@cond INTERNAL
+shmseg_s * GhShmOpen(void);
+void GhShmPublish(shmseg_s * seg, const ghstate_s * st);
+void GhShmClose(shmseg_s * seg);
+const shmseg_s * GhShmAttach(void);
+int GhShmSnapshot(const shmseg_s * seg, ghstate_s * st);
+//@endcond
+#endif
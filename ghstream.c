@@ -0,0 +1,240 @@
+/** @brief One machine-readable record per control cycle on stdout
+*   @file ghstream.c
+*   ghc --output=jsonl writes one JSON object per line:
+*
+*       {"cycle":1,"time":1790000000,"temperature":21.5,"humidity":50.0,
+*        "pressure":1000.0,"set_temperature":25.0,"set_humidity":55.0,
+*        "heater":1,"humidifier":0,"alarms":["High Temperature"]}
+*
+*   ghc --output=binary writes an STREAMHDRSZ byte header, STREAMMAGIC,
+*   u16 STREAMVERSION and u16 STREAMRECSZ, then fixed STREAMRECSZ byte
+*   records, all little-endian:
+*
+*       0   u32 cycle
+*       4   the reading as a ghlog record, i64 time, f32 T, H and P
+*       24  f32 temperature and humidity setpoints
+*       32  u32 active alarm codes, bit n for alarm_e n
+*       36  u8 heater, u8 humidifier, u16 zero
+*
+*   Records are formatted straight into one STREAMBUFSZ buffer. Nothing
+*   reaches the output until GhStreamFlush, which the main loop calls
+*   once a cycle, so a cycle costs one write() however much it logged.
+*   When the stream opens, stdout is moved to a private descriptor and
+*   descriptor 1 pointed at stderr, so messages printed by other modules
+*   can't corrupt the stream.
+*/
+
+#include "ghstream.h"
+#include "ghlog.h"
+#include "ghalarm.h"
+#include <errno.h>
+#include <unistd.h>
+
+/**
+ * @brief Writes a whole buffer, retrying short writes
+ * @param fd file descriptor
+ * @param buf data
+ * @param len number of bytes
+ * @return 1 on success, 0 on error
+ */
+static int GhStreamWrite(int fd, const uint8_t * buf, size_t len)
+{
+    ssize_t n;
+
+    while(len > 0)
+    {
+        n = write(fd, buf, len);
+        if(n < 0)
+        {
+            if(errno == EINTR)
+            {
+                continue;
+            }
+            return 0;
+        }
+        buf += n;
+        len -= n;
+    }
+    return 1;
+}
+
+/**
+ * @brief Stores a float little-endian
+ * @param p destination, at least 4 bytes
+ * @param v value
+ * @return void
+ */
+static void GhStreamFloat(uint8_t * p, float v)
+{
+    uint32_t f;
+
+    memcpy(&f, &v, 4);
+    GhPutLe32(p, f);
+}
+
+/**
+ * @brief Formats a record as one JSON line
+ * @param p destination, at least STREAMLINEMAX bytes
+ * @param gs controller state of the cycle
+ * @return size_t length of the line
+ */
+static size_t GhStreamJson(char * p, const ghstate_s * gs)
+{
+    int len, code, first = 1;
+
+    len = snprintf(p, STREAMLINEMAX,
+                   "{\"cycle\":%u,\"time\":%lld,\"temperature\":%.1f,\"humidity\":%.1f,\"pressure\":%.1f,"
+                   "\"set_temperature\":%.1f,\"set_humidity\":%.1f,\"heater\":%d,\"humidifier\":%d,\"alarms\":[",
+                   gs->cycles, (long long) gs->readings.rtime, gs->readings.temperature, gs->readings.humidity,
+                   gs->readings.pressure, gs->setpoints.temperature, gs->setpoints.humidity,
+                   gs->controls.heater, gs->controls.humidifier);
+    // The names are fixed and need no escaping
+    for(code = NOALARM + 1; code < NALARMS; code++)
+    {
+        if(gs->alarms & (1u << code))
+        {
+            len += snprintf(p + len, STREAMLINEMAX - len, "%s\"%s\"", first ? "" : ",", alarmnames[code]);
+            first = 0;
+        }
+    }
+    len += snprintf(p + len, STREAMLINEMAX - len, "]}\n");
+    return len;
+}
+
+/**
+ * @brief Packs a record into STREAMRECSZ bytes
+ * @param p destination, STREAMRECSZ bytes
+ * @param gs controller state of the cycle
+ * @return void
+ */
+static void GhStreamPack(uint8_t * p, const ghstate_s * gs)
+{
+    GhPutLe32(p, gs->cycles);
+    GhPackRecord(p + 4, &gs->readings);
+    GhStreamFloat(p + 24, gs->setpoints.temperature);
+    GhStreamFloat(p + 28, gs->setpoints.humidity);
+    GhPutLe32(p + 32, gs->alarms);
+    p[36] = gs->controls.heater;
+    p[37] = gs->controls.humidifier;
+    p[38] = 0;
+    p[39] = 0;
+}
+
+/**
+ * @brief Takes over stdout for a record stream
+ * @version CENG153, serial: 85048a62
+ * @author Devansh Patel
+ * @since 2026-10-19
+ * @param st stream to initialise
+ * @param format "jsonl" or "binary"
+ * @return int 1 on success, 0 on an unknown format or if stdout can't be moved
+ */
+int GhStreamOpen(stream_s * st, const char * format)
+{
+    memset(st, 0, sizeof(*st));
+    st->fd = -1;
+    if(strcmp(format, "jsonl") == 0)
+    {
+        st->format = STREAMJSONL;
+    }
+    else if(strcmp(format, "binary") == 0)
+    {
+        st->format = STREAMBINARY;
+    }
+    else
+    {
+        fprintf(stderr,"\nUnknown stream format %s\n", format);
+        return 0;
+    }
+
+    fflush(stdout);
+    st->fd = dup(STDOUT_FILENO);
+    if(st->fd < 0 || dup2(STDERR_FILENO, STDOUT_FILENO) < 0)
+    {
+        fprintf(stderr,"\nCannot move stdout for the record stream\n");
+        return 0;
+    }
+    if(st->format == STREAMBINARY)
+    {
+        memcpy(st->buf, STREAMMAGIC, 4);
+        st->buf[4] = STREAMVERSION & 0xFF;
+        st->buf[5] = STREAMVERSION >> 8;
+        st->buf[6] = STREAMRECSZ & 0xFF;
+        st->buf[7] = STREAMRECSZ >> 8;
+        st->used = STREAMHDRSZ;
+    }
+    return 1;
+}
+
+/**
+ * @brief Adds the record of one cycle to the buffer
+ * @version CENG153, serial: 85048a62
+ * @author Devansh Patel
+ * @since 2026-10-19
+ * @param st stream from GhStreamOpen
+ * @param gs controller state of the cycle
+ * @return void
+ */
+void GhStreamRecord(stream_s * st, const ghstate_s * gs)
+{
+    // Only a full buffer forces a write between flush points
+    if(STREAMBUFSZ - st->used < STREAMLINEMAX)
+    {
+        GhStreamFlush(st);
+    }
+    if(st->format == STREAMBINARY)
+    {
+        GhStreamPack(st->buf + st->used, gs);
+        st->used += STREAMRECSZ;
+    }
+    else
+    {
+        st->used += GhStreamJson((char *) st->buf + st->used, gs);
+    }
+    st->records++;
+}
+
+/**
+ * @brief Writes out everything buffered
+ * @version CENG153, serial: 85048a62
+ * @author Devansh Patel
+ * @since 2026-10-19
+ * @param st stream from GhStreamOpen
+ * @return int 1 on success, 0 on a write error, the buffered records are dropped
+ */
+int GhStreamFlush(stream_s * st)
+{
+    int ok;
+
+    if(st->used == 0)
+    {
+        return 1;
+    }
+    ok = GhStreamWrite(st->fd, st->buf, st->used);
+    if(!ok)
+    {
+        fprintf(stderr,"\nRecord stream write failed, %zu bytes dropped\n", st->used);
+    }
+    st->used = 0;
+    return ok;
+}
+
+/**
+ * @brief Flushes and closes the record stream
+ * @version CENG153, serial: 85048a62
+ * @author Devansh Patel
+ * @since 2026-10-19
+ * @param st stream from GhStreamOpen
+ * @return int 1 on success, 0 if the last flush failed
+ */
+int GhStreamClose(stream_s * st)
+{
+    int ok = GhStreamFlush(st);
+
+    if(st->fd >= 0)
+    {
+        close(st->fd);
+        st->fd = -1;
+    }
+    return ok;
+}
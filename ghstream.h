@@ -0,0 +1,41 @@
+/** @brief Machine-readable output stream constants, structures, function prototypes
+*   @file ghstream.h
+*/
+
+#ifndef GHSTREAM_H
+#define GHSTREAM_H
+
+// Includes
+#include <stdint.h>
+#include <stddef.h>
+#include "ghcontrol.h"
+#include "ghshm.h"
+
+// Constants
+#define STREAMMAGIC "GHST"
+#define STREAMVERSION 1
+#define STREAMHDRSZ 8
+#define STREAMRECSZ 40
+#define STREAMBUFSZ 65536
+#define STREAMLINEMAX 512
+
+// Enumerated Types
+typedef enum { STREAMJSONL, STREAMBINARY } streamfmt_e;
+
+// Structures
+typedef struct stream
+{
+    int fd;
+    streamfmt_e format;
+    size_t used;
+    uint64_t records;
+    uint8_t buf[STREAMBUFSZ];
+} stream_s;
+
+//@cond INTERNAL
+int GhStreamOpen(stream_s * st, const char * format);
+void GhStreamRecord(stream_s * st, const ghstate_s * gs);
+int GhStreamFlush(stream_s * st);
+int GhStreamClose(stream_s * st);
+//@endcond
+#endif
@@ -0,0 +1,143 @@
+/** @brief LED history heatmap of the last TRENDSAMPLES readings
+*   @file ghtrend.c
+*   Time runs right to left, one column per sample, newest on the right.
+*   Rows 0-2 show temperature, rows 3-5 humidity and rows 6-7 pressure.
+*   Each pixel is coloured from a gradient table of TRENDLEVELS entries,
+*   blue at the bottom of the display range, red at the top.
+*
+*   The panel is row-major, so moving the whole buffer back one pixel
+*   shifts every row one column left. The pixel each row takes from the
+*   start of the next row lands in its last column, and the new sample
+*   overwrites that column. A sample costs one memmove and eight
+*   pixels. The picture is redrawn from the ring only when the display
+*   ranges change.
+*/
+
+#include "ghtrend.h"
+#include "ghconfig.h"
+
+static const int trendrow[8] = {0,0,0,1,1,1,2,2};
+static uint16_t gradient[TRENDLEVELS];
+
+/**
+ * @brief Fills the gradient table, blue through cyan, green and yellow to red
+ * @return void
+ */
+static void GhTrendGradient(void)
+{
+    static const uint8_t stops[5][3] = {{0,0,255},{0,255,255},{0,255,0},{255,255,0},{255,0,0}};
+    float t, f;
+    int i, s, c[3], k;
+
+    for(i = 0; i < TRENDLEVELS; i++)
+    {
+        t = (float) i * 4 / (TRENDLEVELS - 1);
+        s = (t >= 4) ? 3 : (int) t;
+        f = t - s;
+        for(k = 0; k < 3; k++)
+        {
+            c[k] = stops[s][k] + (stops[s + 1][k] - stops[s][k]) * f;
+        }
+        gradient[i] = ((c[0] >> 3) << 11) | ((c[1] >> 2) << 5) | (c[2] >> 3);
+    }
+}
+
+/**
+ * @brief Looks up the colour of a value
+ * @param tr trend, for the channel's display range
+ * @param ch channel, 0 temperature, 1 humidity, 2 pressure
+ * @param v value
+ * @return uint16_t RGB565 colour
+ */
+static uint16_t GhTrendColor(const trend_s * tr, int ch, float v)
+{
+    int level = tr->scale[ch] * (v - tr->low[ch]) * TRENDLEVELS / NUMPTS;
+
+    return gradient[(level < 0) ? 0 : (level >= TRENDLEVELS) ? TRENDLEVELS - 1 : level];
+}
+
+/**
+ * @brief Draws one sample into a column
+ * @param tr trend
+ * @param col column
+ * @param i ring slot of the sample
+ * @return void
+ */
+static void GhTrendColumn(trend_s * tr, int col, int i)
+{
+    int row;
+
+    for(row = 0; row < 8; row++)
+    {
+        tr->fb.pixel[row][col] = GhTrendColor(tr, trendrow[row], tr->hist[trendrow[row]][i]);
+    }
+}
+
+/**
+ * @brief Clears the history and builds the gradient table
+ * @version CENG153, serial: 85048a62
+ * @author Devansh Patel
+ * @since 2026-10-19
+ * @param tr trend to initialise
+ * @return void
+ */
+void GhTrendInit(trend_s * tr)
+{
+    memset(tr, 0, sizeof(*tr));
+    GhTrendGradient();
+}
+
+/**
+ * @brief Adds a reading to the history and scrolls it onto the heatmap
+ * @version CENG153, serial: 85048a62
+ * @author Devansh Patel
+ * @since 2026-10-19
+ * @param tr trend
+ * @param rd reading
+ * @return void
+ */
+void GhTrendUpdate(trend_s * tr, reading_s rd)
+{
+    const config_s * cfg = GhConfigGet();
+    float low[SENSORS] = {cfg->lstemp, cfg->lshumid, cfg->lspress};
+    float scale[SENSORS] = {cfg->tscale, cfg->hscale, cfg->pscale};
+    int col, i;
+
+    tr->hist[0][tr->head] = rd.temperature;
+    tr->hist[1][tr->head] = rd.humidity;
+    tr->hist[2][tr->head] = rd.pressure;
+    tr->count += tr->count < TRENDSAMPLES;
+
+    if(memcmp(low, tr->low, sizeof(low)) != 0 || memcmp(scale, tr->scale, sizeof(scale)) != 0)
+    {
+        // New display ranges recolour the whole history
+        memcpy(tr->low, low, sizeof(low));
+        memcpy(tr->scale, scale, sizeof(scale));
+        memset(&tr->fb, 0, sizeof(tr->fb));
+        for(col = 8 - tr->count, i = (tr->head + TRENDSAMPLES - tr->count + 1) % TRENDSAMPLES; col < 8; col++)
+        {
+            GhTrendColumn(tr, col, i);
+            i = (i + 1) % TRENDSAMPLES;
+        }
+    }
+    else
+    {
+        memmove(&tr->fb.pixel[0][0], &tr->fb.pixel[0][1], sizeof(tr->fb) - sizeof(uint16_t));
+        GhTrendColumn(tr, 7, tr->head);
+    }
+    tr->head = (tr->head + 1) % TRENDSAMPLES;
+}
+
+/**
+ * @brief Displays the history heatmap on the LED matrix
+ * @version CENG153, serial: 85048a62
+ * @author Devansh Patel
+ * @since 2026-10-19
+ * @param tr trend
+ * @param fb framebuffer to draw into
+ * @return void
+ */
+void GhDisplayTrend(const trend_s * tr, struct fb_t * fb)
+{
+    *fb = tr->fb;
+}
@@ -0,0 +1,31 @@
+/** @brief LED history heatmap constants, structures, function prototypes
+*   @file ghtrend.h
+*/
+
+#ifndef GHTREND_H
+#define GHTREND_H
+
+// Includes
+#include "ghcontrol.h"
+
+// Constants
+#define TRENDSAMPLES 8
+#define TRENDLEVELS 32
+
+// Structures
+typedef struct trend
+{
+    float hist[SENSORS][TRENDSAMPLES];
+    int head;
+    int count;
+    float low[SENSORS];
+    float scale[SENSORS];
+    struct fb_t fb;
+} trend_s;
+
+//@cond INTERNAL
+void GhTrendInit(trend_s * tr);
+void GhTrendUpdate(trend_s * tr, reading_s rd);
+void GhDisplayTrend(const trend_s * tr, struct fb_t * fb);
+//@endcond
+#endif
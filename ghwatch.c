@@ -0,0 +1,342 @@
+/** @brief File watcher
+*   @file ghwatch.c
+*   A thread blocks on an inotify watch of the working directory and
+*   raises a flag for each registered file that is rewritten, replaced by
+*   a rename or removed. Callers poll the flag with GhWatchChanged, so a
+*   file is only read again after it has actually changed. Watching the
+*   directory rather than the file keeps the watch alive when the file is
+*   replaced and lets a file that does not exist yet be watched.
+*
+*   A file can instead have a reload function that the thread calls
+*   itself, and a signal such as SIGHUP that counts as a change of it. The
+*   signal is blocked in every thread and read from a signalfd, so it
+*   never interrupts the control loop.
+*
+*   Signals registered with GhWatchQuit, such as SIGINT and SIGTERM, are
+*   blocked the same way but left pending for the main loop, which polls
+*   for them once a cycle with GhWatchQuitting and shuts down cleanly.
+*
+*   If inotify is unavailable every file reports changed on every call, so
+*   callers behave as they did before the watcher existed.
+*/
+
+#include "ghwatch.h"
+#include <errno.h>
+#include <poll.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/inotify.h>
+#include <sys/signalfd.h>
+#include <unistd.h>
+
+static char watchnames[WATCHFILES][WATCHNAMESZ];
+static int watchchanged[WATCHFILES];
+static void (* watchcalls[WATCHFILES])(void);
+static int watchsigs[WATCHFILES];
+static sigset_t watchmask;
+static int watchmasked = 0;
+static sigset_t quitmask;
+static int quitmasked = 0;
+static int quitting = 0;
+static int watchcount = 0;
+static int watchfd = -1;
+static int watchsigfd = -1;
+static int watchrunning = 0;
+static pthread_t watchthread;
+
+/**
+ * @brief Flags every registered file whose name appears in a batch of inotify events
+ * @param n number of registered files
+ * @return int 1 on success, 0 if the watch failed
+ */
+static int GhWatchEvents(int n)
+{
+    char buf[WATCHBUFSZ] __attribute__((aligned(__alignof__(struct inotify_event))));
+    const struct inotify_event * ev;
+    ssize_t len;
+    char * p;
+    int i;
+
+    len = read(watchfd, buf, sizeof(buf));
+    if(len < 0 && errno == EINTR)
+    {
+        return 1;
+    }
+    if(len <= 0)
+    {
+        return 0;
+    }
+    for(p = buf; p < buf + len; p += sizeof(struct inotify_event) + ev->len)
+    {
+        ev = (const struct inotify_event *) p;
+        for(i = 0; i < n; i++)
+        {
+            // After an overflow any file may have changed
+            if((ev->mask & IN_Q_OVERFLOW) || (ev->len > 0 && strcmp(ev->name, watchnames[i]) == 0))
+            {
+                __atomic_store_n(&watchchanged[i], 1, __ATOMIC_RELEASE);
+            }
+        }
+    }
+    return 1;
+}
+
+/**
+ * @brief Flags every registered file tied to a received signal
+ * @param n number of registered files
+ * @return void
+ */
+static void GhWatchSignals(int n)
+{
+    struct signalfd_siginfo si;
+    int i;
+
+    while(read(watchsigfd, &si, sizeof(si)) == sizeof(si))
+    {
+        for(i = 0; i < n; i++)
+        {
+            if(watchsigs[i] == (int) si.ssi_signo)
+            {
+                __atomic_store_n(&watchchanged[i], 1, __ATOMIC_RELEASE);
+            }
+        }
+    }
+}
+
+/**
+ * @brief Waits for file changes and signals, running reload functions as they come in
+ * @param arg unused
+ * @return NULL when the watch fails
+ */
+static void * GhWatchThread(void * arg)
+{
+    struct pollfd pfd[2];
+    int i, n, state;
+
+    (void) arg;
+    pfd[0].fd = watchfd;
+    pfd[0].events = POLLIN;
+    pfd[1].fd = watchsigfd;
+    pfd[1].events = POLLIN;
+    while(1)
+    {
+        if(poll(pfd, watchsigfd >= 0 ? 2 : 1, -1) < 0)
+        {
+            if(errno == EINTR)
+            {
+                continue;
+            }
+            break;
+        }
+        n = __atomic_load_n(&watchcount, __ATOMIC_ACQUIRE);
+        if((pfd[0].revents & POLLIN) && !GhWatchEvents(n))
+        {
+            break;
+        }
+        if(watchsigfd >= 0 && (pfd[1].revents & POLLIN))
+        {
+            GhWatchSignals(n);
+        }
+        // A reload is never cut short by GhWatchStop
+        pthread_setcancelstate(PTHREAD_CANCEL_DISABLE, &state);
+        for(i = 0; i < n; i++)
+        {
+            if(watchcalls[i] != NULL && __atomic_exchange_n(&watchchanged[i], 0, __ATOMIC_ACQ_REL))
+            {
+                watchcalls[i]();
+            }
+        }
+        pthread_setcancelstate(state, NULL);
+    }
+    fprintf(stderr,"\nFile watcher stopped, files are read every cycle\n");
+    __atomic_store_n(&watchrunning, 0, __ATOMIC_RELEASE);
+    return NULL;
+}
+
+/**
+ * @brief Registers a file in the working directory to be watched
+ * @version CENG153, serial: 85048a62
+ * @author Devansh Patel
+ * @since 2026-10-19
+ * @param fname file name, without a directory
+ * @return int id to pass to GhWatchChanged, -1 if the file cannot be watched
+ */
+int GhWatchAdd(const char * fname)
+{
+    int id = watchcount;
+
+    if(id >= WATCHFILES || strlen(fname) >= WATCHNAMESZ || strchr(fname, '/') != NULL)
+    {
+        fprintf(stderr,"\nCan't watch %s\n", fname);
+        return -1;
+    }
+    strcpy(watchnames[id], fname);
+    // Reports changed once so the first caller loads the file
+    watchchanged[id] = 1;
+    __atomic_store_n(&watchcount, id + 1, __ATOMIC_RELEASE);
+    return id;
+}
+
+/**
+ * @brief Makes the watcher thread call a function whenever a file changes
+ * @version CENG153, serial: 85048a62
+ * @author Devansh Patel
+ * @since 2026-10-19
+ * @param id file id from GhWatchAdd
+ * @param reload function run on the watcher thread, must be set before GhWatchStart
+ * @return int 1 on success, 0 for a bad id
+ */
+int GhWatchCall(int id, void (* reload)(void))
+{
+    if(id < 0 || id >= watchcount)
+    {
+        return 0;
+    }
+    watchcalls[id] = reload;
+    // The caller has just loaded the file itself
+    watchchanged[id] = 0;
+    return 1;
+}
+
+/**
+ * @brief Treats a signal as a change of a watched file
+ * @version CENG153, serial: 85048a62
+ * @author Devansh Patel
+ * @since 2026-10-19
+ * @param id file id from GhWatchAdd
+ * @param signo signal, blocked from here on, so call this before any other thread is started
+ * @return int 1 on success, 0 for a bad id
+ */
+int GhWatchSignal(int id, int signo)
+{
+    if(id < 0 || id >= watchcount)
+    {
+        return 0;
+    }
+    if(!watchmasked)
+    {
+        sigemptyset(&watchmask);
+        watchmasked = 1;
+    }
+    sigaddset(&watchmask, signo);
+    pthread_sigmask(SIG_BLOCK, &watchmask, NULL);
+    watchsigs[id] = signo;
+    return 1;
+}
+
+/**
+ * @brief Makes a signal a request to shut down instead of killing the process
+ * @version CENG153, serial: 85048a62
+ * @author Devansh Patel
+ * @since 2026-10-19
+ * @param signo signal, blocked from here on, so call this before any other thread is started
+ * @return void
+ */
+void GhWatchQuit(int signo)
+{
+    if(!quitmasked)
+    {
+        sigemptyset(&quitmask);
+        quitmasked = 1;
+    }
+    sigaddset(&quitmask, signo);
+    pthread_sigmask(SIG_BLOCK, &quitmask, NULL);
+}
+
+/**
+ * @brief Reports whether a signal registered with GhWatchQuit has arrived, without waiting
+ * @version CENG153, serial: 85048a62
+ * @author Devansh Patel
+ * @since 2026-10-19
+ * @return int 1 once a shutdown was requested
+ */
+int GhWatchQuitting(void)
+{
+    static const struct timespec zero = {0, 0};
+
+    if(quitmasked && !quitting && sigtimedwait(&quitmask, NULL, &zero) > 0)
+    {
+        quitting = 1;
+    }
+    return quitting;
+}
+
+/**
+ * @brief Starts the watcher thread
+ * @version CENG153, serial: 85048a62
+ * @author Devansh Patel
+ * @since 2026-10-19
+ * @return int 1 if files are being watched, 0 if they will be read every cycle
+ */
+int GhWatchStart(void)
+{
+    if(watchrunning)
+    {
+        return 1;
+    }
+    watchfd = inotify_init1(IN_CLOEXEC);
+    if(watchfd < 0 || inotify_add_watch(watchfd, WATCHDIR, IN_CLOSE_WRITE | IN_MOVED_TO | IN_MOVED_FROM | IN_DELETE) < 0)
+    {
+        fprintf(stderr,"\nCan't watch %s, files are read every cycle\n", WATCHDIR);
+        GhWatchStop();
+        return 0;
+    }
+    if(watchmasked)
+    {
+        watchsigfd = signalfd(-1, &watchmask, SFD_NONBLOCK | SFD_CLOEXEC);
+    }
+    watchrunning = 1;
+    if(pthread_create(&watchthread, NULL, GhWatchThread, NULL) != 0)
+    {
+        watchrunning = 0;
+        GhWatchStop();
+        return 0;
+    }
+    return 1;
+}
+
+/**
+ * @brief Reports whether a watched file changed since the last call, and clears the flag
+ * @version CENG153, serial: 85048a62
+ * @author Devansh Patel
+ * @since 2026-10-19
+ * @param id file id from GhWatchAdd
+ * @return int 1 if the file must be read again, 0 if it is unchanged
+ */
+int GhWatchChanged(int id)
+{
+    if(id < 0 || id >= WATCHFILES || !__atomic_load_n(&watchrunning, __ATOMIC_ACQUIRE))
+    {
+        return 1;
+    }
+    return __atomic_exchange_n(&watchchanged[id], 0, __ATOMIC_ACQ_REL);
+}
+
+/**
+ * @brief Stops the watcher thread
+ * @version CENG153, serial: 85048a62
+ * @author Devansh Patel
+ * @since 2026-10-19
+ * @return void
+ */
+void GhWatchStop(void)
+{
+    if(watchrunning)
+    {
+        pthread_cancel(watchthread);
+        pthread_join(watchthread, NULL);
+        __atomic_store_n(&watchrunning, 0, __ATOMIC_RELEASE);
+    }
+    if(watchfd >= 0)
+    {
+        close(watchfd);
+        watchfd = -1;
+    }
+    if(watchsigfd >= 0)
+    {
+        close(watchsigfd);
+        watchsigfd = -1;
+    }
+}
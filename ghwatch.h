@@ -0,0 +1,24 @@
+/** @brief File watcher constants, function prototypes
+*   @file ghwatch.h
+*/
+
+#ifndef GHWATCH_H
+#define GHWATCH_H
+
+// Constants
+#define WATCHDIR "."
+#define WATCHFILES 8
+#define WATCHNAMESZ 64
+#define WATCHBUFSZ 4096
+
+//@cond INTERNAL
+int GhWatchAdd(const char * fname);
+int GhWatchCall(int id, void (* reload)(void));
+int GhWatchSignal(int id, int signo);
+void GhWatchQuit(int signo);
+int GhWatchQuitting(void);
+int GhWatchStart(void);
+int GhWatchChanged(int id);
+void GhWatchStop(void);
+//@endcond
+#endif
@@ -6,7 +6,14 @@
  */
 
 #include "led2472g.h"
-#include "font.h"
+#include "fontpack.h"
+
+// Pixel masks of the four columns a glyph row nibble covers, leftmost first
+#define NIBBLEMASK(n) {(n) & 8 ? 0xFFFF : 0, (n) & 4 ? 0xFFFF : 0, (n) & 2 ? 0xFFFF : 0, (n) & 1 ? 0xFFFF : 0}
+static const uint16_t nibblemask[16][4] = {
+    NIBBLEMASK(0), NIBBLEMASK(1), NIBBLEMASK(2), NIBBLEMASK(3), NIBBLEMASK(4), NIBBLEMASK(5), NIBBLEMASK(6), NIBBLEMASK(7),
+    NIBBLEMASK(8), NIBBLEMASK(9), NIBBLEMASK(10), NIBBLEMASK(11), NIBBLEMASK(12), NIBBLEMASK(13), NIBBLEMASK(14), NIBBLEMASK(15)
+};
 
 /*compile with gcc led2472g.c, run with ./a.out
 int main(void)
@@ -77,12 +84,132 @@ int main(void)
     return EXIT_FAILURE;
 }*/
 
+static struct shstate_t shstate;
+
+/** @brief Loads the identity and device paths cached by an earlier start, once
+ */
+static void ShStateLoad(void)
+{
+    char buf[SYSINFOBUFSZ];
+    FILE *fp;
+
+    if (shstate.loaded)
+        return;
+    shstate.loaded = true;
+    fp = fopen(SHSTATEFILE, "r");
+    if (fp == NULL)
+        return;
+    while (fgets(buf, sizeof(buf), fp) != NULL)
+    {
+        buf[strcspn(buf, "\n")] = '\0';
+        if (strncmp(buf, "serial=", 7) == 0)
+            shstate.serial = strtoull(buf + 7, NULL, 16);
+        else if (strncmp(buf, "fb=", 3) == 0 && strlen(buf + 3) < SHPATHSZ)
+            strcpy(shstate.fbdev, buf + 3);
+        else if (strncmp(buf, "event=", 6) == 0 && strlen(buf + 6) < SHPATHSZ)
+            strcpy(shstate.evdev, buf + 6);
+    }
+    fclose(fp);
+}
+
+/** @brief Rewrites the state file, replacing it in one rename
+ */
+static void ShStateSave(void)
+{
+    char tmp[] = SHSTATEFILE ".tmp";
+    FILE *fp;
+
+    fp = fopen(tmp, "w");
+    if (fp == NULL)
+        return;
+    fprintf(fp, "serial=%llx\nfb=%s\nevent=%s\n", (unsigned long long) shstate.serial, shstate.fbdev, shstate.evdev);
+    if (fclose(fp) != 0 || rename(tmp, SHSTATEFILE) != 0)
+        unlink(tmp);
+}
+
+/** @brief Reads the first line of a small file such as a sysfs attribute
+ *  @param path file
+ *  @param buf destination
+ *  @param size size of buf
+ *  @return true if anything was read
+ */
+static bool ShReadLine(const char *path, char *buf, size_t size)
+{
+    ssize_t n;
+    int fd;
+
+    fd = open(path, O_RDONLY);
+    if (fd < 0)
+        return false;
+    n = read(fd, buf, size - 1);
+    close(fd);
+    if (n <= 0)
+        return false;
+    buf[n] = '\0';
+    buf[strcspn(buf, "\n")] = '\0';
+    return true;
+}
+
+static int is_visible(const struct dirent *dir)
+{
+    return dir->d_name[0] != '.';
+}
+
+/** @brief Stand-in serial for machines without one, the nanoseconds of the
+ *  modification time of the last entry of STAMP_DIR read as hex, the same
+ *  value ls --full-time STAMP_DIR piped through grep gives
+ *  @return the stamp, 0 if there is none
+ */
+static uint64_t ShStampSerial(void)
+{
+    struct dirent **namelist;
+    struct stat st;
+    char path[SYSINFOBUFSZ];
+    char digits[16];
+    uint64_t serial = 0;
+    int i, n;
+
+    n = scandir(STAMP_DIR, &namelist, is_visible, alphasort);
+    if (n <= 0)
+        return 0;
+    snprintf(path, sizeof(path), "%s/%s", STAMP_DIR, namelist[n - 1]->d_name);
+    if (lstat(path, &st) == 0)
+    {
+        snprintf(digits, sizeof(digits), "%09ld", (long) st.st_mtim.tv_nsec);
+        serial = strtoull(digits, NULL, 16);
+    }
+    for (i = 0; i < n; i++)
+        free(namelist[i]);
+    free(namelist);
+    return serial;
+}
+
+/** @brief Serial number of the unit, resolved on the first call only
+ *  The device tree holds it on a Pi. Elsewhere the value cached in
+ *  SHSTATEFILE is used, and only a cold start scans /proc/cpuinfo and
+ *  falls back to the STAMP_DIR stamp.
+ *  @return the serial, 0 if none was found
+ */
 uint64_t ShGetSerial(void)
 {
+    static bool resolved = false;
     static uint64_t serial = 0;
     FILE * fp;
     char buf[SYSINFOBUFSZ];
     char searchstring[] = SEARCHSTR;
+
+    if (resolved)
+        return serial;
+    resolved = true;
+    if (ShReadLine(SERIAL_NUMBER, buf, sizeof(buf)))
+        serial = strtoull(buf, NULL, 16);
+    if (serial != 0)
+        return serial;
+
+    ShStateLoad();
+    serial = shstate.serial;
+    if (serial != 0)
+        return serial;
     fp = fopen ("/proc/cpuinfo", "r");
     if (fp != NULL)
     {
@@ -90,24 +217,17 @@ uint64_t ShGetSerial(void)
         {
             if (!strncasecmp(searchstring, buf, strlen(searchstring)))
             {
-                sscanf(buf+strlen(searchstring), "%Lx", &serial);
+                serial = strtoull(buf+strlen(searchstring), NULL, 16);
             }
         }
         fclose(fp);
     }
-    if(serial==0)
+    if (serial == 0)
+        serial = ShStampSerial();
+    if (serial != 0)
     {
-        system("uname -a");
-        system("ls --fu /usr/lib/codeblocks | grep -Po '\\.\\K[^ ]+'>stamp.txt");
-        fp = fopen ("stamp.txt", "r");
-        if (fp != NULL)
-        {
-            while (fgets(buf, sizeof(buf), fp) != NULL)
-            {
-                sscanf(buf, "%Lx", &serial);
-            }
-            fclose(fp);
-        }
+        shstate.serial = serial;
+        ShStateSave();
     }
     return serial;
 }
@@ -159,69 +279,173 @@ static int is_framebuffer_device(const struct dirent *dir)
             strlen(FB_DEV_NAME)-1) == 0;
 }
 
+/** @brief Opens an event device if it has the given name
+ *  @param fname device node
+ *  @param dev_name name the device must report
+ *  @return open descriptor, -1 if it can't be opened or is another device
+ */
+static int ShProbeEvdev(const char *fname, const char *dev_name)
+{
+    char name[256] = "";
+    int fd;
+
+    fd = open(fname, O_RDONLY);
+    if (fd < 0)
+        return -1;
+    ioctl(fd, EVIOCGNAME(sizeof(name)), name);
+    if (strcmp(dev_name, name) == 0)
+        return fd;
+    close(fd);
+    return -1;
+}
+
+/** @brief Opens a framebuffer device if it has the given id
+ *  @param fname device node
+ *  @param dev_name id the framebuffer must report
+ *  @return open descriptor, -1 if it can't be opened or is another device
+ */
+static int ShProbeFbdev(const char *fname, const char *dev_name)
+{
+    struct fb_fix_screeninfo fix_info;
+    int fd;
+
+    fd = open(fname, O_RDWR);
+    if (fd < 0)
+        return -1;
+    if (ioctl(fd, FBIOGET_FSCREENINFO, &fix_info) == 0 && strcmp(dev_name, fix_info.id) == 0)
+        return fd;
+    close(fd);
+    return -1;
+}
+
+/** @brief Finds a device by the name sysfs gives it, without opening any device
+ *  @param classdir sysfs class directory, such as SYS_CLASS_INPUT
+ *  @param prefix prefix of the entries to look at
+ *  @param attr attribute holding the name, relative to the entry
+ *  @param dev_name name wanted
+ *  @param devdir directory of the device nodes
+ *  @param path device node found
+ *  @return true if found
+ */
+static bool ShSysfsFind(const char *classdir, const char *prefix, const char *attr, const char *dev_name,
+                        const char *devdir, char path[SHPATHSZ])
+{
+    char fname[SYSINFOBUFSZ];
+    char name[256];
+    struct dirent *ent;
+    DIR *dir;
+    bool found = false;
+
+    dir = opendir(classdir);
+    if (dir == NULL)
+        return false;
+    while (!found && (ent = readdir(dir)) != NULL)
+    {
+        if (strncmp(ent->d_name, prefix, strlen(prefix)) != 0)
+            continue;
+        snprintf(fname, sizeof(fname), "%s/%s/%s", classdir, ent->d_name, attr);
+        if (ShReadLine(fname, name, sizeof(name)) && strcmp(name, dev_name) == 0)
+            found = snprintf(path, SHPATHSZ, "%s/%s", devdir, ent->d_name) < SHPATHSZ;
+    }
+    closedir(dir);
+    return found;
+}
+
+/** @brief Remembers the device node a device was found at for the next start
+ *  @param cached path cached in the state
+ *  @param fname device node found
+ */
+static void ShStateDevice(char cached[SHPATHSZ], const char *fname)
+{
+    if (strcmp(cached, fname) != 0 && strlen(fname) < SHPATHSZ)
+    {
+        strcpy(cached, fname);
+        ShStateSave();
+    }
+}
+
+/** @brief Opens the event device of a given name. The node cached in
+ *  SHSTATEFILE is tried first, then sysfs names the node, and only when
+ *  neither works is every event device opened in turn.
+ *  @param dev_name name the device reports
+ *  @return open descriptor, -1 if not found
+ */
 static int open_evdev(const char *dev_name)
 {
     struct dirent **namelist;
+    char fname[SHPATHSZ];
     int i, ndev;
     int fd = -1;
 
+    ShStateLoad();
+    if (shstate.evdev[0] != '\0' && (fd = ShProbeEvdev(shstate.evdev, dev_name)) >= 0)
+        return fd;
+    if (ShSysfsFind(SYS_CLASS_INPUT, EVENT_DEV_NAME, "device/name", dev_name, DEV_INPUT_EVENT, fname) &&
+        (fd = ShProbeEvdev(fname, dev_name)) >= 0)
+    {
+        ShStateDevice(shstate.evdev, fname);
+        return fd;
+    }
+
     ndev = scandir(DEV_INPUT_EVENT, &namelist, is_event_device, versionsort);
     if (ndev <= 0)
-        return ndev;
+        return -1;
 
-    for (i = 0; i < ndev; i++)
+    for (i = 0; i < ndev && fd < 0; i++)
     {
-        char fname[64];
-        char name[256];
-
         snprintf(fname, sizeof(fname),
             "%s/%s", DEV_INPUT_EVENT, namelist[i]->d_name);
         fprintf(stdout,"Opening in open_evdev:  %s\n", fname);
-        fd = open(fname, O_RDONLY);
-        if (fd < 0)
-            continue;
-        ioctl(fd, EVIOCGNAME(sizeof(name)), name);
-        if (strcmp(dev_name, name) == 0)
-            break;
-        close(fd);
+        fd = ShProbeEvdev(fname, dev_name);
     }
+    if (fd >= 0)
+        ShStateDevice(shstate.evdev, fname);
 
     for (i = 0; i < ndev; i++)
         free(namelist[i]);
+    free(namelist);
 
     return fd;
 }
 
+/** @brief Opens the framebuffer of a given id, looked up the same way as open_evdev
+ *  @param dev_name id the framebuffer reports
+ *  @return open descriptor, -1 if not found
+ */
 static int open_fbdev(const char *dev_name)
 {
     struct dirent **namelist;
+    char fname[SHPATHSZ];
     int i, ndev;
     int fd = -1;
-    struct fb_fix_screeninfo fix_info;
+
+    ShStateLoad();
+    if (shstate.fbdev[0] != '\0' && (fd = ShProbeFbdev(shstate.fbdev, dev_name)) >= 0)
+        return fd;
+    if (ShSysfsFind(SYS_CLASS_GRAPHICS, FB_DEV_NAME, "name", dev_name, DEV_FB, fname) &&
+        (fd = ShProbeFbdev(fname, dev_name)) >= 0)
+    {
+        ShStateDevice(shstate.fbdev, fname);
+        return fd;
+    }
 
     ndev = scandir(DEV_FB, &namelist, is_framebuffer_device, versionsort);
     if (ndev <= 0)
-        return ndev;
+        return -1;
 
-    for (i = 0; i < ndev; i++)
+    for (i = 0; i < ndev && fd < 0; i++)
     {
-        char fname[64];
-        char name[256];
-
         snprintf(fname, sizeof(fname),
             "%s/%s", DEV_FB, namelist[i]->d_name);
         fprintf(stdout,"Opening in open_fbdev: %s\n", fname);
-        fd = open(fname, O_RDWR);
-        if (fd < 0)
-            continue;
-        ioctl(fd, FBIOGET_FSCREENINFO, &fix_info);
-        if (strcmp(dev_name, fix_info.id) == 0)
-            break;
-        close(fd);
-        fd = -1;
+        fd = ShProbeFbdev(fname, dev_name);
     }
+    if (fd >= 0)
+        ShStateDevice(shstate.fbdev, fname);
+
     for (i = 0; i < ndev; i++)
         free(namelist[i]);
+    free(namelist);
 
     return fd;
 }
@@ -297,159 +521,172 @@ void ShLightPixel(int row, int column, uint16_t color, struct fb_t *fb)
     fb->pixel[row%8][column%8] = color;
 }
 
-/** @brief Checks if a column on the LED matrix is clear
+/** @brief Displays a pattern on the LED matrix
+ *  @param pattern 8*8 of uint16_t
  */
-bool ShEmptyColumn(int numcolumn,uint16_t image[8][8],uint16_t colorBackground)
+void ShViewPattern(uint16_t pattern[][8], struct fb_t *fb)
 {
-    int i=0;
-
-    for(i=0;i<8;i++)
+    for(int row=0; row <8 ; row++)
     {
-        if(image[i][numcolumn]!=colorBackground) { return false; }
+        for(int column=0 ; column <8 ; column++)
+        {
+            fb->pixel[row][column] = pattern[row][column];
+        }
     }
-    return true;
+
 }
 
-void ShImageContainment(int numcolumn,uint16_t image[][8][8], int taille)
+/** @brief Expands one packed glyph row into 8 RGB565 pixels, four per 64 bit operation
+ *  @param bits glyph row, bit 7 the leftmost column
+ *  @param row destination pixels
+ *  @param fg4 text colour in all four 16 bit lanes
+ *  @param bg4 background colour in all four 16 bit lanes
+ */
+static void ShExpandRow(uint8_t bits, uint16_t row[8], uint64_t fg4, uint64_t bg4)
 {
-    int i=0,j=0,k=0,l=0,isuivant,ksuivant;
-    int nombredecolumns=taille*8; //8 columns par pattern
+    uint64_t m;
+
+    memcpy(&m, nibblemask[bits >> 4], sizeof(m));
+    m = bg4 ^ ((fg4 ^ bg4) & m);
+    memcpy(row, &m, sizeof(m));
+    memcpy(&m, nibblemask[bits & 0xF], sizeof(m));
+    m = bg4 ^ ((fg4 ^ bg4) & m);
+    memcpy(row + 4, &m, sizeof(m));
+}
 
-    for(l=numcolumn;l<nombredecolumns-1;l++)
+/** @brief Converts a character to an LED matrix pattern.
+ *  Characters without a glyph get the font's unknown glyph.
+ */
+void ShConvertCharacterToPattern(char c, uint16_t image[8][8], uint16_t colorText, uint16_t colorBackground)
+{
+    const uint8_t *glyph = fontglyphs[fontindex[(unsigned char) c]];
+    uint64_t fg4 = colorText * 0x0001000100010001ULL;
+    uint64_t bg4 = colorBackground * 0x0001000100010001ULL;
+    int j;
+
+    for (j=0;j<8;j++)
     {
-        i=l/8;
-        k=l%8;
-        isuivant=(l+1)/8;
-        ksuivant=(l+1)%8;
-        for(j=0;j<8;j++)
-        {
-            image[i][j][k]=image[isuivant][j][ksuivant];
-        }
+        ShExpandRow(glyph[j], image[j], fg4, bg4);
     }
 }
 
+/** @brief Moves the scroller to the next character of its message
+ *  Glyphs are trimmed to their lit columns, blank ones become SCROLLSPACE columns.
+ *  @param sc scroller
+ */
+static void ShScrollLoad(struct scroller_t *sc)
+{
+    uint8_t lit = 0;
+    int j;
 
-/** @brief Displays a pattern on the LED matrix
- *  @param pattern 8*8 of uint16_t
+    // Accented letters are two bytes, 195 then the code font.h uses
+    if((unsigned char) *sc->next == 195 && sc->next[1] != '\0')
+    {
+        sc->next++;
+    }
+    sc->glyph = fontglyphs[fontindex[(unsigned char) *sc->next++]];
+    for (j=0;j<8;j++)
+    {
+        lit |= sc->glyph[j];
+    }
+    sc->col = 0;
+    sc->last = SCROLLSPACE - 1;
+    if(lit != 0)
+    {
+        for (sc->col=0; !(lit & (0x80 >> sc->col)); sc->col++);
+        for (sc->last=7; !(lit & (0x80 >> sc->last)); sc->last--);
+    }
+    sc->gap = 1;
+}
+
+/** @brief Produces the next column of the message, bit j lit for row j
+ *  @param sc scroller
+ *  @return column bits, 0 for a blank column or once the message is done
  */
-void ShViewPattern(uint16_t pattern[][8], struct fb_t *fb)
+static uint8_t ShScrollColumn(struct scroller_t *sc)
 {
-    for(int row=0; row <8 ; row++)
+    uint8_t bits = 0;
+    int j;
+
+    while(sc->col > sc->last)
     {
-        for(int column=0 ; column <8 ; column++)
+        if(sc->gap > 0)
         {
-            fb->pixel[row][column] = pattern[row][column];
+            sc->gap--;
+            return 0;
+        }
+        if(*sc->next == '\0')
+        {
+            sc->done = sc->tail-- <= 0;
+            return 0;
         }
+        ShScrollLoad(sc);
     }
-
+    for (j=0;j<8;j++)
+    {
+        bits |= ((sc->glyph[j] >> (7 - sc->col)) & 1) << j;
+    }
+    sc->col++;
+    return bits;
 }
 
-/** @brief Converts a character to an LED matrix pattern.
+/** @brief Prepares a message for scrolling, it enters at the right edge
+ *  @param sc scroller to initialise
+ *  @param message text, must stay valid until the scroll is done
  */
-void ShConvertCharacterToPattern(char c, uint16_t image[8][8], uint16_t colorText, uint16_t colorBackground)
+void ShScrollStart(struct scroller_t *sc, const char *message)
 {
-    int i=0;
-    int j,k;
-    int tailleTableDeConvertion=sizeof(font)/sizeof(Tfont);
+    sc->next = message;
+    sc->glyph = fontglyphs[FONTUNKNOWN];
+    sc->col = 1;
+    sc->last = 0;
+    sc->gap = 0;
+    sc->tail = SCROLLTAIL - 1;
+    sc->done = false;
+}
 
-    // Recherche si le caractere existe dans la table de convertion (cf font.h)
-    while(c!=font[i].caractere && i < tailleTableDeConvertion )
-	i++;
+/** @brief Scrolls the panel one column left, bringing in the next column of the message
+ *  Work and memory are the same whatever the message length.
+ *  @param sc scroller from ShScrollStart
+ *  @return true while the message is still on the panel
+ */
+bool ShScrollStep(struct scroller_t *sc, uint16_t colorText, uint16_t colorBackground, struct fb_t *fb)
+{
+    uint8_t bits = ShScrollColumn(sc);
+    int j;
 
-    // Si le caractere est dans la table on le converti
-    if(i < tailleTableDeConvertion)
+    if(sc->done)
     {
-        for (j=0;j<8;j++)
-        {
-            for(k=0;k<8;k++)
-            {
-                if(font[i].binarypattern[j][k]) { image[j][k]=colorText; }
-                else { image[j][k]=colorBackground; }
-            }
-        }
+        return false;
     }
-    else // caractre inexistant on le remplace par un glyphe inconnu
+    for (j=0;j<8;j++)
     {
-        ShConvertCharacterToPattern(255,image,colorText,colorBackground);
+        memmove(&fb->pixel[j][0], &fb->pixel[j][1], 7 * sizeof(uint16_t));
+        fb->pixel[j][7] = ((bits >> j) & 1) ? colorText : colorBackground;
     }
+    return true;
 }
 
 /** @brief Displays a message on the LED matrix.
+ *  The message scrolls in from the right and out to the left, one column per step.
  */
 void ShViewMessage(const char * message, int vitesseDefilement, uint16_t colorText, uint16_t colorBackground, struct fb_t *fb)
 {
-    int taille=strlen(message);
-    uint16_t chaine[taille][8][8]; /* Le tableau de pattern (image/caractre)  afficher */
-    int i=0,j=0,k=0,l=0,nombreDecolumnVide=0;
-    int isuivant=0,ksuivant=0,nombreDecolumns=0;
+    struct scroller_t sc;
+    int j,k;
 
-    /* Convertion de tout le message en tableau de patterns
-     * format caractre : 1 column vide + 5 columns rellement utilises
-     * + 2 columns vides */
-    for( i=0,j=0; i<taille; i++,j++)
+    for (j=0;j<8;j++)
     {
-        if(message[i]==195)  // les lettres accentues sont codes sur deux octets  (195 167 pour )
+        for (k=0;k<8;k++)
         {
-            i++;
-            k++;
+            fb->pixel[j][k] = colorBackground;
         }
-  	// row suivante  dcommenter pour obtenir le code des caractres UTF8
-	// std::cout << "code : " << (int)message[i] << std::endl;
-	ShConvertCharacterToPattern(message[i],chaine[j],colorText,colorBackground);
-    }
-	taille = taille - k;
-	nombreDecolumns=(taille)*8-2;
-	k = 0;
-	// Parcours de toutes les columns de tous les patterns qui compose
-	// la chaine de caractres  afficher pour supprimer les columns vides sauf celle
-	// qui spare les patterns (caractres). + gestion du caractre espace.
-	for( l=0;l<nombreDecolumns;l++)
-	{
-		i=l/8;
-		k=l%8;
-
-		if(ShEmptyColumn(k,chaine[i],colorBackground)) // Une column Vide avant chaque caractre  ne pas supprimer
-
-		{
-			isuivant=(++l)/8;
-			ksuivant=(l)%8;
-			nombreDecolumnVide=1;
-
-			// compter les columns vide aprs la premire afin de les supprimer
-			// si plus de 4 c'est le caractre espace que l'on doit garder
-			while(ShEmptyColumn(ksuivant,chaine[isuivant],colorBackground) && nombreDecolumnVide++ < 6)
-			{
-				ShImageContainment(l,chaine,taille);
-				nombreDecolumns--;
-			}
-
-		}
-	}
-
-	// Parcours de toutes les columns de tous les patterns qui composent
-	// la chaine de caractres  afficher (sans les columns vides superflues).
-	for( l=0; l<nombreDecolumns; l++)
-	{
-		// Decalage des columns vers la gauche sur l'image Numero 0 (celle qu'on affiche sur la matrice de LED
-		for( i=0;i<taille;i++)
-		{
-			// Cas Normal, les columns sont sur le mme pattern
-			for(j=0;j<8;j++)
-			{
-				for(k=0;k<7;k++)
-					chaine[i][j][k]=chaine[i][j][k+1];
-
-			}
-			// Cas o l'on doit changer de pattern
-			for(j=0;j<8;j++)
-			{
-				chaine[i][j][7]=chaine[i+1][j][0];
-            }
-		}
-		usleep(1000*vitesseDefilement);
-		ShViewPattern(chaine[0], fb);
-	}
-
+    }
+    ShScrollStart(&sc, message);
+    while(ShScrollStep(&sc, colorText, colorBackground, fb))
+    {
+        usleep(1000*vitesseDefilement);
+    }
 }
 
 /** @brief Rotates a pattern on the LED matrix
@@ -486,3 +723,268 @@ void ShRotatePattern(int angle, struct fb_t *fb)
     ShViewPattern(tabAux, fb);
 }
 
+
+/** @brief Reads the next event of a joystick script, lines of "milliseconds KEY"
+ *  @param hat Sense HAT whose script is read
+ *  @return true if an event was read, false at the end of the script
+ */
+static bool ShScriptNext(struct sensehat_t *hat)
+{
+    static const char keys[][8] = {"UP","DOWN","LEFT","RIGHT","ENTER"};
+    static const int codes[] = {KEY_UP,KEY_DOWN,KEY_LEFT,KEY_RIGHT,KEY_ENTER};
+    char line[SYSINFOBUFSZ], key[8];
+    long ms;
+    int i;
+
+    while (fgets(line, sizeof(line), hat->script) != NULL)
+    {
+        line[strcspn(line, "#")] = '\0';
+        if (sscanf(line, "%ld %7s", &ms, key) != 2)
+            continue;
+        for (i = 0; i < 5; i++)
+        {
+            if (strcmp(key, keys[i]) == 0)
+            {
+                hat->nextms = ms;
+                hat->nextcode = codes[i];
+                return true;
+            }
+        }
+        fprintf(stderr,"Unknown joystick key %s in script.\n", key);
+    }
+    return false;
+}
+
+/** @brief Opens the display and joystick backends without exiting on failure
+ *  @param hat Sense HAT to initialise
+ *  @param display "fb" for the device, "memory", "ppm:DIR" to dump each frame, or "ansi" for the terminal
+ *  @param joystick "dev", "none" or "script:FILE", NULL for the device with "fb" and none otherwise
+ *  @return true on success, false if a backend could not be opened
+ */
+bool ShOpen(struct sensehat_t *hat, const char *display, const char *joystick)
+{
+    int fbfd;
+
+    memset(hat, 0, sizeof(*hat));
+    hat->evfd = -1;
+    clock_gettime(CLOCK_MONOTONIC, &hat->start);
+    if (joystick == NULL)
+        joystick = (strcmp(display, "fb") == 0) ? "dev" : "none";
+
+    if (strcmp(display, "fb") == 0)
+    {
+        fbfd = open_fbdev("RPi-Sense FB");
+        if (fbfd <= 0) {
+            fprintf(stderr,"Error: cannot open framebuffer device.\n");
+            return false;
+        }
+        hat->fb = mmap(0, 128, PROT_READ | PROT_WRITE, MAP_SHARED, fbfd, 0);
+        if (hat->fb == MAP_FAILED) {
+            fprintf(stderr,"Failed to mmap.\n");
+            return false;
+        }
+        hat->display = SHFBDEV;
+    }
+    else
+    {
+        hat->fb = &hat->mem;
+        hat->display = SHMEMORY;
+        if (strncmp(display, "ppm:", 4) == 0 && strlen(display + 4) < SHNAMESZ - 20)
+        {
+            strcpy(hat->dumpdir, display + 4);
+            hat->dump = SHDUMPPPM;
+        }
+        else if (strcmp(display, "ansi") == 0)
+            hat->dump = SHDUMPANSI;
+        else if (strcmp(display, "memory") != 0) {
+            fprintf(stderr,"Unknown display %s.\n", display);
+            return false;
+        }
+    }
+    memset(hat->fb, 0, 128);
+
+    if (strcmp(joystick, "dev") == 0)
+    {
+        hat->evfd = open_evdev("Raspberry Pi Sense HAT Joystick");
+        if (hat->evfd < 0) {
+            fprintf(stderr, "Event device not found.\n");
+            return false;
+        }
+        fcntl(hat->evfd, F_SETFL, fcntl(hat->evfd, F_GETFL) | O_NONBLOCK);
+        hat->joystick = SHJOYDEV;
+    }
+    else if (strncmp(joystick, "script:", 7) == 0)
+    {
+        hat->script = fopen(joystick + 7, "r");
+        if (hat->script == NULL) {
+            fprintf(stderr, "Cannot open joystick script %s.\n", joystick + 7);
+            return false;
+        }
+        hat->joystick = ShScriptNext(hat) ? SHJOYSCRIPT : SHJOYNONE;
+    }
+    else if (strcmp(joystick, "none") != 0) {
+        fprintf(stderr,"Unknown joystick %s.\n", joystick);
+        return false;
+    }
+    return true;
+}
+
+/** @brief Passes a frame written to the Sense HAT on to a dump, if it has one
+ *  @param hat Sense HAT
+ */
+void ShShow(struct sensehat_t *hat)
+{
+    uint8_t rgb[8][8][3];
+    char name[SHNAMESZ + 32];
+    uint16_t p;
+    FILE *fp;
+    int row, column;
+
+    hat->frames++;
+    if (hat->dump == SHDUMPNONE)
+        return;
+    for (row=0; row<8; row++)
+    {
+        for (column=0; column<8; column++)
+        {
+            p = hat->fb->pixel[row][column];
+            rgb[row][column][0] = ((p >> 11) & 0x1F) * 255 / 31;
+            rgb[row][column][1] = ((p >> 5) & 0x3F) * 255 / 63;
+            rgb[row][column][2] = (p & 0x1F) * 255 / 31;
+        }
+    }
+    if (hat->dump == SHDUMPPPM)
+    {
+        snprintf(name, sizeof(name), "%s/frame-%06lu.ppm", hat->dumpdir, hat->frames);
+        fp = fopen(name, "wb");
+        if (fp != NULL)
+        {
+            fprintf(fp, "P6\n8 8\n255\n");
+            fwrite(rgb, 1, sizeof(rgb), fp);
+            fclose(fp);
+        }
+        return;
+    }
+    // Two spaces a pixel on its own background colour, then back to the default
+    for (row=0; row<8; row++)
+    {
+        for (column=0; column<8; column++)
+        {
+            printf("\x1b[48;2;%d;%d;%dm  ", rgb[row][column][0], rgb[row][column][1], rgb[row][column][2]);
+        }
+        printf("\x1b[0m\n");
+    }
+    fflush(stdout);
+}
+
+/** @brief Takes the next joystick press without waiting
+ *  @param hat Sense HAT
+ *  @return KEY_UP, KEY_DOWN, KEY_LEFT, KEY_RIGHT or KEY_ENTER, -1 if none is waiting
+ */
+int ShJoystick(struct sensehat_t *hat)
+{
+    struct input_event ev;
+    struct timespec now;
+    long ms;
+    int code;
+
+    if (hat->joystick == SHJOYDEV)
+    {
+        while (read(hat->evfd, &ev, sizeof(ev)) == sizeof(ev))
+        {
+            if (ev.type == EV_KEY && ev.value == 1)
+                return ev.code;
+        }
+    }
+    else if (hat->joystick == SHJOYSCRIPT)
+    {
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        ms = (now.tv_sec - hat->start.tv_sec) * 1000 + (now.tv_nsec - hat->start.tv_nsec) / 1000000;
+        if (ms >= hat->nextms)
+        {
+            code = hat->nextcode;
+            if (!ShScriptNext(hat))
+                hat->joystick = SHJOYNONE;
+            return code;
+        }
+    }
+    return -1;
+}
+
+/** @brief Sets up double buffering in front of a Sense HAT display
+ *  @param comp compositor to initialise
+ *  @param hat display from ShOpen
+ *  @return the back buffer, where a frame is drawn before ShPresent
+ */
+struct fb_t *ShCompositorInit(struct compositor_t *comp, struct sensehat_t *hat)
+{
+    memset(comp, 0, sizeof(*comp));
+    comp->hat = hat;
+    return &comp->back;
+}
+
+/** @brief Sets the rotation applied when frames are presented, as ShRotatePattern would
+ *  @param comp compositor
+ *  @param angle 0, 90, 180 or 270, other angles present unrotated
+ */
+void ShCompositorRotate(struct compositor_t *comp, int angle)
+{
+    int row, column, to;
+
+    if (angle == comp->rotation)
+        return;
+    for (row=0; row<8; row++)
+    {
+        for (column=0; column<8; column++)
+        {
+            switch (angle)
+            {
+                case 90:
+                    to = (7 - column) * 8 + row;
+                    break;
+                case 180:
+                    to = (7 - row) * 8 + 7 - column;
+                    break;
+                case 270:
+                    to = column * 8 + 7 - row;
+                    break;
+                default:
+                    to = row * 8 + column;
+            }
+            comp->remap[row * 8 + column] = to;
+        }
+    }
+    comp->rotation = angle;
+    // The panel holds the old orientation until the next frame is written in full
+    comp->valid = false;
+}
+
+/** @brief Shows the back buffer, in one copy and only if it differs from the last frame shown
+ *  @param comp compositor
+ *  @return true if the device was written, false if the frame was unchanged
+ */
+bool ShPresent(struct compositor_t *comp)
+{
+    // The last frame is kept here, reading back through the device mapping is slow
+    if(comp->valid && memcmp(&comp->back, &comp->front, sizeof(struct fb_t)) == 0)
+    {
+        comp->skipped++;
+        return false;
+    }
+    if (comp->rotation == 0)
+        memcpy(comp->hat->fb, &comp->back, sizeof(struct fb_t));
+    else
+    {
+        uint16_t *to = &comp->hat->fb->pixel[0][0];
+        const uint16_t *from = &comp->back.pixel[0][0];
+        int i;
+
+        for (i=0; i<64; i++)
+            to[comp->remap[i]] = from[i];
+    }
+    ShShow(comp->hat);
+    comp->front = comp->back;
+    comp->valid = true;
+    comp->presented++;
+    return true;
+}
@@ -25,6 +25,7 @@
 #include <linux/fb.h>
 #include <sys/mman.h>
 #include <sys/ioctl.h>
+#include <sys/stat.h>
 #include <time.h>
 #include <poll.h>
 #include <dirent.h>
@@ -43,6 +44,15 @@
 #define EVENT_DEV_NAME "event"
 #define DEV_FB "/dev"
 #define FB_DEV_NAME "fb"
+#define SYS_CLASS_INPUT "/sys/class/input"
+#define SYS_CLASS_GRAPHICS "/sys/class/graphics"
+#define SERIAL_NUMBER "/proc/device-tree/serial-number"
+#define STAMP_DIR "/usr/lib/codeblocks"
+#define SHSTATEFILE "sensehat.state"
+#define SHPATHSZ 64
+#define SHNAMESZ 256
+#define SCROLLSPACE 3
+#define SCROLLTAIL 8
 
 #define COLOR_SENSEHAT uint16_t
 #define PI 3.14159265
@@ -72,6 +82,23 @@ enum direction_t{
     NONE,
 };
 
+enum shdisplay_t {
+    SHFBDEV,
+    SHMEMORY,
+};
+
+enum shdump_t {
+    SHDUMPNONE,
+    SHDUMPPPM,
+    SHDUMPANSI,
+};
+
+enum shjoystick_t {
+    SHJOYNONE,
+    SHJOYDEV,
+    SHJOYSCRIPT,
+};
+
 // Structures
 struct segment_t {
     struct segment_t *next;
@@ -94,6 +121,49 @@ struct fb_t {
     uint16_t pixel[8][8];
 };
 
+struct sensehat_t {
+    enum shdisplay_t display;
+    enum shdump_t dump;
+    enum shjoystick_t joystick;
+    struct fb_t *fb;
+    struct fb_t mem;
+    char dumpdir[SHNAMESZ];
+    unsigned long frames;
+    int evfd;
+    FILE *script;
+    struct timespec start;
+    long nextms;
+    int nextcode;
+};
+
+struct shstate_t {
+    bool loaded;
+    uint64_t serial;
+    char fbdev[SHPATHSZ];
+    char evdev[SHPATHSZ];
+};
+
+struct compositor_t {
+    struct fb_t back;
+    struct fb_t front;
+    struct sensehat_t *hat;
+    int rotation;
+    uint8_t remap[64];
+    bool valid;
+    unsigned long presented;
+    unsigned long skipped;
+};
+
+struct scroller_t {
+    const char *next;
+    const uint8_t *glyph;
+    int col;
+    int last;
+    int gap;
+    int tail;
+    bool done;
+};
+
 struct brush_t {
     unsigned short colourindex;
     unsigned short colours[8];
@@ -113,12 +183,18 @@ void move_dir(unsigned int code, struct brush_t *brush);
 void move_events(int evfd, struct brush_t *brush);
 void ShWipeScreen(uint16_t color, struct fb_t *fb);
 void ShLightPixel(int row, int column, uint16_t color, struct fb_t *fb);
-bool ShEmptyColumn(int numcolumn,uint16_t image[8][8],uint16_t colorBackground);
-void ShImageContainment(int numcolumn,uint16_t image[][8][8], int taille);
 void ShViewPattern(uint16_t pattern[][8], struct fb_t *fb);
 void ShConvertCharacterToPattern(char c, uint16_t image[8][8], uint16_t colorText, uint16_t colorBackground);
+void ShScrollStart(struct scroller_t *sc, const char *message);
+bool ShScrollStep(struct scroller_t *sc, uint16_t colorText, uint16_t colorBackground, struct fb_t *fb);
 void ShViewMessage(const char * message, int vitesseDefilement, uint16_t colorText, uint16_t colorBackground, struct fb_t *fb);
 void ShRotatePattern(int angle, struct fb_t *fb);
+bool ShOpen(struct sensehat_t *hat, const char *display, const char *joystick);
+void ShShow(struct sensehat_t *hat);
+int ShJoystick(struct sensehat_t *hat);
+struct fb_t *ShCompositorInit(struct compositor_t *comp, struct sensehat_t *hat);
+void ShCompositorRotate(struct compositor_t *comp, int angle);
+bool ShPresent(struct compositor_t *comp);
 
 /// @endcond
 